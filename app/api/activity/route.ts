@@ -0,0 +1,11 @@
+import { type NextRequest, NextResponse } from "next/server"
+import { ktpCoreUrl, proxyToCore } from "@/lib/ktp-core"
+
+// GET handler for the activity timeline: ?date=YYYY-MM-DD or ?from=&to= (Unix seconds)
+// Only the C++ core records verification/edit/undo times, so this route requires KTP_CORE_URL.
+export async function GET(request: NextRequest) {
+  if (!ktpCoreUrl) {
+    return NextResponse.json({ error: "Activity timeline requires KTP_CORE_URL" }, { status: 501 })
+  }
+  return proxyToCore(request, "/api/activity")
+}
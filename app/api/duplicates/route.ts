@@ -0,0 +1,11 @@
+import { type NextRequest, NextResponse } from "next/server"
+import { ktpCoreUrl, proxyToCore } from "@/lib/ktp-core"
+
+// GET handler for probable duplicate applicants: ?id= for one application, no query for all clusters
+// The duplicate index lives in the C++ core, so this route requires KTP_CORE_URL.
+export async function GET(request: NextRequest) {
+  if (!ktpCoreUrl) {
+    return NextResponse.json({ error: "Duplicate detection requires KTP_CORE_URL" }, { status: 501 })
+  }
+  return proxyToCore(request, "/api/duplicates")
+}
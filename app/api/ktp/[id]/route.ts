@@ -1,8 +1,11 @@
 import { type NextRequest, NextResponse } from "next/server"
 import { supabase } from "@/lib/supabase"
+import { ktpCoreUrl, proxyToCore } from "@/lib/ktp-core"
 
 // GET handler to retrieve a specific application
 export async function GET(request: NextRequest, { params }: { params: { id: string } }) {
+  if (ktpCoreUrl) return proxyToCore(request, `/api/ktp/${encodeURIComponent(params.id)}`)
+
   const id = params.id
 
   const { data, error } = await supabase.from("ktp_applications").select("*").eq("id", id).single()
@@ -16,6 +19,8 @@ export async function GET(request: NextRequest, { params }: { params: { id: stri
 
 // PUT handler to update an application
 export async function PUT(request: NextRequest, { params }: { params: { id: string } }) {
+  if (ktpCoreUrl) return proxyToCore(request, `/api/ktp/${encodeURIComponent(params.id)}`)
+
   try {
     const id = params.id
     const body = await request.json()
@@ -76,6 +81,8 @@ export async function PUT(request: NextRequest, { params }: { params: { id: stri
 
 // PATCH handler to verify an application
 export async function PATCH(request: NextRequest, { params }: { params: { id: string } }) {
+  if (ktpCoreUrl) return proxyToCore(request, `/api/ktp/${encodeURIComponent(params.id)}`)
+
   try {
     const id = params.id
     const body = await request.json()
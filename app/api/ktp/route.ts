@@ -1,8 +1,11 @@
 import { type NextRequest, NextResponse } from "next/server"
 import { supabase } from "@/lib/supabase"
+import { ktpCoreUrl, proxyToCore } from "@/lib/ktp-core"
 
 // GET handler to retrieve all applications
-export async function GET() {
+export async function GET(request: NextRequest) {
+  if (ktpCoreUrl) return proxyToCore(request, "/api/ktp")
+
   const { data, error } = await supabase
     .from("ktp_applications")
     .select("*")
@@ -17,6 +20,8 @@ export async function GET() {
 
 // POST handler to create a new application
 export async function POST(request: NextRequest) {
+  if (ktpCoreUrl) return proxyToCore(request, "/api/ktp")
+
   try {
     const body = await request.json()
 
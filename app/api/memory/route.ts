@@ -0,0 +1,11 @@
+import { type NextRequest, NextResponse } from "next/server"
+import { ktpCoreUrl, proxyToCore } from "@/lib/ktp-core"
+
+// GET handler for the estimated memory footprint of each data structure in the C++ core
+// There is no Supabase equivalent, so this route requires KTP_CORE_URL.
+export async function GET(request: NextRequest) {
+  if (!ktpCoreUrl) {
+    return NextResponse.json({ error: "Memory reporting requires KTP_CORE_URL" }, { status: 501 })
+  }
+  return proxyToCore(request, "/api/memory")
+}
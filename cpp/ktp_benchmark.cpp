@@ -0,0 +1,926 @@
+// Benchmark untuk setiap operasi KtpSystem (versi lokal)
+//
+// Build:  g++ -std=c++17 -O2 cpp/ktp_benchmark.cpp -o cpp/output/ktp_benchmark
+// Jalan:  ./cpp/output/ktp_benchmark [--sizes 10000,1000000,10000000] [--ops N] [--out file.jsonl] [--workdir dir]
+//         ./cpp/output/ktp_benchmark --self-check [--workdir dir]
+//
+// Setiap baris output adalah satu objek JSON (JSON Lines) per operasi per ukuran data,
+// sehingga hasilnya bisa dibandingkan dengan baseline sebelumnya. --self-check menjalankan
+// pemeriksaan kebenaran singkat (pemulihan snapshot, dst.) dan keluar dengan kode 1 bila gagal.
+#define KTP_NO_MAIN
+#include "ktp_system_bst_local.cpp"
+
+#include <chrono>
+#include <random>
+#include <cmath>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// --- Generator data sintetis ---
+
+static const vector<string> FIRST_NAMES = {
+    "Muhammad", "Siti", "Budi", "Dewi", "Agus", "Sri", "Andi", "Rina", "Ahmad", "Nur",
+    "Eko", "Wahyu", "Putri", "Rizki", "Dian", "Hendra", "Fitri", "Joko", "Indah", "Bayu",
+    "Ayu", "Dedi", "Yuni", "Arif", "Lestari", "Fajar", "Ratna", "Hadi", "Wulan", "Irfan",
+    "Maya", "Taufik", "Nadia", "Rudi", "Sari", "Yusuf", "Intan", "Bambang", "Tri", "Dimas",
+    "Citra", "Gilang", "Kartika", "Reza", "Novi", "Iwan", "Anisa", "Hari", "Mega", "Teguh",
+    "Rahmat", "Lina", "Aditya", "Ningsih", "Surya", "Eka", "Galih", "Permata", "Yoga", "Aulia",
+    "Ilham", "Retno", "Bagus", "Sinta", "Dwi", "Endang", "Firman", "Handayani", "Imam", "Jamal",
+    "Kurnia", "Lukman", "Mulyadi", "Nanda", "Oktavia", "Pratama", "Qori", "Rafi", "Slamet", "Tika",
+    "Umar", "Vina", "Wawan", "Yanti", "Zainal", "Asep", "Ujang", "Nyoman", "Made", "Ketut",
+    "Wayan", "Putu", "Kadek", "Gede", "Komang", "Cahya", "Bima", "Laras", "Sekar", "Danu"
+};
+
+static const vector<string> MIDDLE_NAMES = {
+    "", "", "", "", "", "", "", "", "", "",
+    "Adi", "Nur", "Dwi", "Tri", "Eka", "Sri", "Putra", "Putri", "Budi", "Dewi",
+    "Indra", "Jaya", "Kusuma", "Wati", "Hidayat", "Rahman", "Sari", "Ayu", "Dian", "Maulana",
+    "Surya", "Agung", "Bayu", "Cahya", "Permana", "Ratna", "Wijaya", "Yudha", "Lestari", "Fadli",
+    "Akbar", "Rahayu", "Prima", "Kencana", "Mulia", "Arya", "Satria", "Tirta", "Candra", "Wira"
+};
+
+static const vector<string> LAST_NAMES = {
+    "Saputra", "Wijaya", "Santoso", "Setiawan", "Hidayat", "Nugroho", "Pratama", "Kurniawan", "Susanto", "Gunawan",
+    "Siregar", "Nasution", "Lubis", "Harahap", "Simanjuntak", "Sitompul", "Pardede", "Hutapea", "Sinaga", "Tambunan",
+    "Wibowo", "Purnomo", "Hartono", "Suryadi", "Rahmawati", "Handoko", "Halim", "Salim", "Tanjung", "Syahputra",
+    "Firmansyah", "Ramadhan", "Kusumawati", "Lestari", "Permana", "Utomo", "Prasetyo", "Sulistyo", "Maharani", "Anggraini",
+    "Putri", "Sari", "Fauzi", "Hakim", "Iskandar", "Yulianti", "Wahyudi", "Suharto", "Sudirman", "Rusdi",
+    "Batubara", "Panjaitan", "Manurung", "Sihombing", "Situmorang", "Pohan", "Daulay", "Ritonga", "Matondang", "Hasibuan",
+    "Tarigan", "Ginting", "Sembiring", "Karo", "Bangun", "Pelawi", "Surbakti", "Sitepu", "Perangin", "Barus",
+    "Mandagi", "Lumban", "Rumondor", "Pangemanan", "Tumbelaka", "Wenas", "Sondakh", "Lasut", "Kaunang", "Rondonuwu",
+    "Pattinama", "Latuconsina", "Pattiasina", "Leiwakabessy", "Tuasikal", "Matulessy", "Siahaya", "Lekatompessy", "Sahetapy", "Ralahalu",
+    "Pangaribuan", "Silalahi", "Simbolon", "Napitupulu", "Sianturi", "Hutagalung", "Pakpahan", "Sitorus", "Marpaung", "Samosir"
+};
+
+// Region dengan bobot kira-kira sebanding dengan jumlah penduduk
+static const vector<pair<string, double>> REGIONS = {
+    {"Jakarta", 10.6}, {"Surabaya", 2.9}, {"Bandung", 2.5}, {"Bekasi", 2.5}, {"Medan", 2.4},
+    {"Depok", 2.1}, {"Tangerang", 1.9}, {"Palembang", 1.7}, {"Semarang", 1.7}, {"Makassar", 1.4},
+    {"Batam", 1.2}, {"Bogor", 1.1}, {"Pekanbaru", 1.1}, {"Bandar Lampung", 1.1}, {"Padang", 0.9},
+    {"Malang", 0.9}, {"Samarinda", 0.8}, {"Denpasar", 0.7}, {"Banjarmasin", 0.7}, {"Pontianak", 0.7},
+    {"Yogyakarta", 0.4}, {"Manado", 0.4}, {"Kupang", 0.4}, {"Jayapura", 0.4}, {"Ambon", 0.3},
+    {"Mataram", 0.4}, {"Jambi", 0.6}, {"Cirebon", 0.3}, {"Tegal", 0.3}, {"Serang", 0.7}
+};
+
+static const vector<string> STREETS = {
+    "Merdeka", "Sudirman", "Thamrin", "Diponegoro", "Gatot Subroto", "Ahmad Yani", "Pemuda", "Pahlawan",
+    "Kartini", "Imam Bonjol", "Veteran", "Gajah Mada", "Hayam Wuruk", "Sisingamangaraja", "Mawar", "Melati",
+    "Kenanga", "Anggrek", "Cempaka", "Flamboyan", "Teuku Umar", "Cut Nyak Dien", "Hasanuddin", "Pattimura"
+};
+
+// Distribusi Zipf sederhana: indeks ke-i berbobot 1 / (i+1)^s
+static discrete_distribution<size_t> zipf(size_t n, double s) {
+    vector<double> weights(n);
+    for (size_t i = 0; i < n; ++i) {
+        weights[i] = 1.0 / pow(static_cast<double>(i + 1), s);
+    }
+    return discrete_distribution<size_t>(weights.begin(), weights.end());
+}
+
+class ApplicantGenerator {
+private:
+    mt19937_64 rng;
+    discrete_distribution<size_t> firstDist;
+    uniform_int_distribution<size_t> middleDist;
+    discrete_distribution<size_t> lastDist;
+    discrete_distribution<size_t> regionDist;
+    uniform_int_distribution<size_t> streetDist;
+    uniform_int_distribution<int> numberDist;
+    uniform_int_distribution<int> rtDist;
+    uniform_real_distribution<double> statusDist;
+
+public:
+    explicit ApplicantGenerator(uint64_t seed)
+        : rng(seed),
+          firstDist(zipf(FIRST_NAMES.size(), 0.6)),
+          middleDist(0, MIDDLE_NAMES.size() - 1),
+          lastDist(zipf(LAST_NAMES.size(), 0.6)),
+          regionDist(),
+          streetDist(0, STREETS.size() - 1),
+          numberDist(1, 250),
+          rtDist(1, 20),
+          statusDist(0.0, 1.0) {
+        vector<double> weights;
+        for (const auto& region : REGIONS) {
+            weights.push_back(region.second);
+        }
+        regionDist = discrete_distribution<size_t>(weights.begin(), weights.end());
+    }
+
+    string name() {
+        string result = FIRST_NAMES[firstDist(rng)];
+        const string& middle = MIDDLE_NAMES[middleDist(rng)];
+        if (!middle.empty()) {
+            result += " " + middle;
+        }
+        return result + " " + LAST_NAMES[lastDist(rng)];
+    }
+
+    string address(const string& region) {
+        return "Jl. " + STREETS[streetDist(rng)] + " No. " + to_string(numberDist(rng)) + ", RT " +
+               to_string(rtDist(rng)) + "/RW " + to_string(rtDist(rng)) + ", " + region;
+    }
+
+    string region() {
+        return REGIONS[regionDist(rng)].first;
+    }
+
+    string status() {
+        double roll = statusDist(rng);
+        if (roll < 0.6) return "pending";
+        if (roll < 0.9) return "verified";
+        return "revision";
+    }
+
+    size_t index(size_t n) {
+        return uniform_int_distribution<size_t>(0, n - 1)(rng);
+    }
+};
+
+// Menulis n aplikasi sintetis ke <root>/data/ktp_applications.txt dan mengembalikan ID-nya
+static vector<string> writeSyntheticData(const fs::path& root, size_t n, uint64_t seed) {
+    fs::create_directories(root / "data");
+    fs::remove(root / "data" / "ktp_revisions.txt");
+    fs::remove(root / "data" / "ktp_events.txt");
+    fs::remove(root / "data" / "ktp_manifest.txt");
+
+    ApplicantGenerator gen(seed);
+    vector<string> ids;
+    ids.reserve(n);
+    time_t baseTime = 1700000000;
+
+    ofstream file(root / "data" / "ktp_applications.txt");
+    for (size_t i = 0; i < n; ++i) {
+        string region = gen.region();
+        time_t submitted = baseTime + static_cast<time_t>(i);
+        string id = region + "-" + to_string(submitted);
+        file << id << '\t' << gen.name() << '\t' << gen.address(region) << '\t' << region << '\t'
+             << submitted << '\t' << gen.status() << '\n';
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+// --- Pengukuran ---
+
+static long peakRssKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<long>(counters.PeakWorkingSetSize / 1024);
+    }
+    return -1;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss; // Linux: kilobyte
+#endif
+}
+
+// Streambuf yang membuang semua output (untuk membungkam cout milik KtpSystem)
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    streamsize xsputn(const char*, streamsize n) override { return n; }
+};
+
+struct OpResult {
+    string op;
+    vector<double> latenciesUs;
+    double totalSec = 0.0;
+    size_t recordsPerOp = 1; // Untuk load/save: jumlah record yang diproses per operasi
+};
+
+class Benchmark {
+private:
+    ostream& out;
+    NullBuffer nullBuffer;
+
+    static double percentile(vector<double> values, double p) {
+        if (values.empty()) return 0.0;
+        size_t rank = static_cast<size_t>(ceil(p * static_cast<double>(values.size())));
+        rank = rank == 0 ? 0 : rank - 1;
+        nth_element(values.begin(), values.begin() + static_cast<long>(rank), values.end());
+        return values[rank];
+    }
+
+    template <typename Fn>
+    OpResult measure(const string& op, size_t samples, Fn&& fn) {
+        OpResult result;
+        result.op = op;
+        result.latenciesUs.reserve(samples);
+        streambuf* original = cout.rdbuf(&nullBuffer);
+        for (size_t i = 0; i < samples; ++i) {
+            auto start = chrono::steady_clock::now();
+            fn(i);
+            auto end = chrono::steady_clock::now();
+            double us = chrono::duration<double, micro>(end - start).count();
+            result.latenciesUs.push_back(us);
+            result.totalSec += us / 1e6;
+        }
+        cout.rdbuf(original);
+        return result;
+    }
+
+    // Seperti measure(), tetapi setup(i) dijalankan sebelum setiap sampel dan tidak ikut diukur
+    template <typename Setup, typename Fn>
+    OpResult measureWithSetup(const string& op, size_t samples, Setup&& setup, Fn&& fn) {
+        OpResult result;
+        for (size_t i = 0; i < samples; ++i) {
+            setup(i);
+            OpResult one = measure(op, 1, [&](size_t) { fn(i); });
+            result.latenciesUs.push_back(one.latenciesUs[0]);
+            result.totalSec += one.totalSec;
+        }
+        result.op = op;
+        return result;
+    }
+
+    // Membandingkan sort lama (list::sort / std::stable_sort dengan lambda) dengan kernel ktp_sort.h
+    // pada data yang sama di memori, dengan tuple kunci yang sama di kedua sisi sehingga hasilnya
+    // identik. Input diacak ulang sebelum setiap sampel; baris kernel memuat speedup terhadap legacy.
+    void runSortComparison(size_t size, size_t samples) {
+        ApplicantGenerator gen(99 + size);
+        vector<Applicant> input;
+        input.reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            string region = gen.region();
+            input.push_back({region + "-" + to_string(i), gen.name(), gen.address(region), region,
+                             static_cast<time_t>(1700000000 + gen.index(size * 10)), gen.status()});
+        }
+
+        list<Applicant> queue;
+        vector<Applicant> records;
+        auto resetQueue = [&](size_t) { queue.assign(input.begin(), input.end()); };
+        auto resetRecords = [&](size_t) { records = input; };
+        auto byRegionStatusName = [](const Applicant& a, const Applicant& b) {
+            return tie(a.region, a.status, a.name) < tie(b.region, b.status, b.name);
+        };
+        auto byTime = [](const Applicant& a, const Applicant& b) { return a.submissionTime < b.submissionTime; };
+        auto project = [](list<Applicant>::iterator it) -> const Applicant& { return *it; };
+
+        // Kernel mengurutkan iterator lalu memindahkan node (seperti KtpSystem::reorderQueue)
+        auto kernelListSort = [&](auto sortOrder) {
+            vector<list<Applicant>::iterator> order;
+            order.reserve(queue.size());
+            for (auto it = queue.begin(); it != queue.end(); ++it) order.push_back(it);
+            sortOrder(order);
+            for (auto it : order) queue.splice(queue.end(), queue, it);
+        };
+
+        auto compare = [&](const string& legacyName, OpResult legacy, const string& kernelName, OpResult kernel) {
+            legacy.op = legacyName;
+            legacy.recordsPerOp = size;
+            kernel.op = kernelName;
+            kernel.recordsPerOp = size;
+            report(size, legacy);
+            report(size, kernel, &legacy);
+        };
+        compare("sort_region_legacy", measureWithSetup("", samples, resetQueue, [&](size_t) {
+                    queue.sort(byRegionStatusName);
+                }),
+                "sort_region_kernel", measureWithSetup("", samples, resetQueue, [&](size_t) {
+                    kernelListSort([&](vector<list<Applicant>::iterator>& order) {
+                        sortByKeys<ktpsort::ByRegion, ktpsort::ByStatus, ktpsort::ByName>(order, project);
+                    });
+                }));
+        compare("sort_time_legacy", measureWithSetup("", samples, resetQueue, [&](size_t) {
+                    queue.sort(byTime);
+                }),
+                "sort_time_radix", measureWithSetup("", samples, resetQueue, [&](size_t) {
+                    kernelListSort([&](vector<list<Applicant>::iterator>& order) {
+                        sortByKeys<ktpsort::ByTime>(order, project);
+                    });
+                }));
+        compare("sort_vector_region_legacy", measureWithSetup("", samples, resetRecords, [&](size_t) {
+                    stable_sort(records.begin(), records.end(), byRegionStatusName);
+                }),
+                "sort_vector_region_kernel", measureWithSetup("", samples, resetRecords, [&](size_t) {
+                    sortByKeys<ktpsort::ByRegion, ktpsort::ByStatus, ktpsort::ByName>(
+                        records, [](const Applicant& app) -> const Applicant& { return app; });
+                }));
+    }
+
+    // baseline: bila diisi, baris ini juga memuat speedup p50 terhadap operasi baseline
+    void report(size_t size, const OpResult& result, const OpResult* baseline = nullptr) {
+        double opsPerSec = result.totalSec > 0 ? static_cast<double>(result.latenciesUs.size()) / result.totalSec : 0.0;
+        out << "{\"size\":" << size
+            << ",\"op\":\"" << result.op << "\""
+            << ",\"samples\":" << result.latenciesUs.size()
+            << ",\"total_ms\":" << result.totalSec * 1e3
+            << ",\"ops_per_sec\":" << opsPerSec
+            << ",\"records_per_sec\":" << opsPerSec * static_cast<double>(result.recordsPerOp)
+            << ",\"p50_us\":" << percentile(result.latenciesUs, 0.50)
+            << ",\"p99_us\":" << percentile(result.latenciesUs, 0.99);
+        if (baseline != nullptr) {
+            double p50 = percentile(result.latenciesUs, 0.50);
+            out << ",\"baseline\":\"" << baseline->op << "\""
+                << ",\"speedup\":" << (p50 > 0 ? percentile(baseline->latenciesUs, 0.50) / p50 : 0.0);
+        }
+        out << ",\"peak_rss_kb\":" << peakRssKb() << "}" << endl;
+    }
+
+public:
+    explicit Benchmark(ostream& output) : out(output) {}
+
+    // opsOverride == 0 berarti jumlah sampel dipilih otomatis berdasarkan ukuran data
+    void run(const fs::path& workDir, size_t size, size_t opsOverride) {
+        // Setiap operasi tulis menyimpan ulang seluruh file (O(n)), jadi jumlah sampel diskalakan
+        size_t mutationSamples = opsOverride ? opsOverride : max<size_t>(3, min<size_t>(500, 2000000 / size));
+        size_t bulkSamples = opsOverride ? max<size_t>(1, opsOverride / 10) : max<size_t>(1, min<size_t>(20, 1000000 / size));
+
+        fs::path root = workDir / ("bench_" + to_string(size));
+        cerr << "[bench] Membuat " << size << " aplikasi sintetis di " << root.string() << endl;
+        vector<string> ids = writeSyntheticData(root, size, 42 + size);
+        ApplicantGenerator gen(7 + size);
+
+        // Instance sebelumnya dibongkar di setup (tidak diukur), sehingga "load" hanya mencakup
+        // membaca file dan membangun struktur data
+        unique_ptr<KtpSystem> system;
+        streambuf* original = cout.rdbuf(&nullBuffer);
+        OpResult load = measureWithSetup("load", bulkSamples, [&](size_t) { system.reset(); }, [&](size_t) {
+            system = make_unique<KtpSystem>(root.string());
+        });
+        cout.rdbuf(original);
+        load.recordsPerOp = size;
+        report(size, load);
+
+        OpResult save = measure("save", bulkSamples, [&](size_t) { system->saveData(); });
+        save.recordsPerOp = size;
+        report(size, save);
+
+        report(size, measure("submit", mutationSamples, [&](size_t) {
+            string region = gen.region();
+            system->submitApplication(gen.name(), gen.address(region), region);
+        }));
+
+        report(size, measure("verify", mutationSamples, [&](size_t) {
+            system->processVerification(ids[gen.index(ids.size())]);
+        }));
+
+        vector<string> editedIds;
+        report(size, measure("edit", mutationSamples, [&](size_t) {
+            const string& id = ids[gen.index(ids.size())];
+            string region = gen.region();
+            system->editApplication(id, gen.name(), gen.address(region), region);
+            editedIds.push_back(id);
+        }));
+
+        report(size, measure("undo", editedIds.size(), [&](size_t i) {
+            system->undoRevision(editedIds[editedIds.size() - 1 - i]);
+        }));
+
+        // Lama stateMutex ditahan writeSnapshot: snapshot delta (satu ID berubah) dibandingkan
+        // snapshot penuh setelah urutan antrian berubah
+        OpResult deltaLock, fullLock;
+        deltaLock.op = "snapshot_lock_delta";
+        fullLock.op = "snapshot_lock_full";
+        original = cout.rdbuf(&nullBuffer);
+        for (size_t i = 0; i < bulkSamples; ++i) {
+            string region = gen.region();
+            system->editApplication(ids[gen.index(ids.size())], gen.name(), gen.address(region), region);
+            system->saveData();
+            deltaLock.latenciesUs.push_back(static_cast<double>(system->snapshotLockNanos()) / 1e3);
+            system->sortByTime();
+            system->saveData();
+            fullLock.latenciesUs.push_back(static_cast<double>(system->snapshotLockNanos()) / 1e3);
+        }
+        cout.rdbuf(original);
+        for (OpResult* lockResult : {&deltaLock, &fullLock}) {
+            for (double us : lockResult->latenciesUs) lockResult->totalSec += us / 1e6;
+            report(size, *lockResult);
+        }
+
+        report(size, measure("display_name", bulkSamples, [&](size_t) { system->displayByBSTName(); }));
+        report(size, measure("display_region", bulkSamples, [&](size_t) {
+            system->sortByRegion();
+            system->displayQueue();
+        }));
+        report(size, measure("display_time", bulkSamples, [&](size_t) {
+            system->sortByTime();
+            system->displayQueue();
+        }));
+
+        system.reset();
+        fs::remove_all(root);
+
+        runSortComparison(size, max<size_t>(3, bulkSamples));
+    }
+};
+
+// --- Pemeriksaan kebenaran (--self-check) ---
+
+class SelfCheck {
+private:
+    fs::path workDir;
+    NullBuffer nullBuffer;
+    size_t passed = 0;
+    size_t failed = 0;
+
+    void check(bool condition, const string& what) {
+        cout << (condition ? "[ok]    " : "[GAGAL] ") << what << endl;
+        (condition ? passed : failed)++;
+    }
+
+    // Menjalankan fn dengan output KtpSystem dibungkam
+    template <typename Fn>
+    void quiet(Fn&& fn) {
+        streambuf* original = cout.rdbuf(&nullBuffer);
+        fn();
+        cout.rdbuf(original);
+    }
+
+    static void copyOver(const fs::path& from, const fs::path& to) {
+        fs::copy_file(from, to, fs::copy_options::overwrite_existing);
+    }
+
+    static bool hasTmpFiles(const fs::path& dir) {
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            if (entry.path().extension() == ".tmp") return true;
+        }
+        return false;
+    }
+
+    // Body request dengan karakter kontrol (mentah atau escape) ditolak karena nilainya ditulis ke
+    // file snapshot yang dipisahkan tab/newline; baris status remote boleh memuat newline
+    void checkJsonControlCharacters() {
+        auto parses = [](const string& text, bool allowControl = false) {
+            map<string, string> fields;
+            return parseFlatJson(text, fields, allowControl);
+        };
+        check(parses("{\"name\":\"Andr\\u00e9\"}"), "json: escape \\u di atas 0x1f diterima");
+        check(!parses("{\"name\":\"A\\u0000B\"}") && !parses("{\"name\":\"A\\u001fB\"}"),
+              "json: \\u0000..\\u001f ditolak");
+        check(!parses("{\"name\":\"A\\nB\"}") && !parses("{\"name\":\"A\\tB\"}"), "json: escape \\n dan \\t ditolak");
+        check(!parses("{\"name\":\"A\nB\"}") && !parses("{\"name\":\"A\tB\"}", true), "json: karakter kontrol mentah ditolak");
+        check(parses("{\"message\":\"baris 1\\nbaris 2\"}", true), "json: escape kontrol diizinkan untuk baris status remote");
+    }
+
+    // dumpStats tidak boleh mengubah flag/presisi stream tujuan (mis. cout untuk menu berikutnya)
+    void checkMetricsFormat() {
+        KtpMetrics local;
+        local.enable();
+        local.record(KtpMetric::Submit, 1234567);
+        ostringstream out;
+        streamsize precision = out.precision();
+        ios::fmtflags flags = out.flags();
+        local.dumpStats(out);
+        check(out.precision() == precision && out.flags() == flags && out.str().find("1.235") != string::npos,
+              "metrik: dumpStats tidak mengubah presisi dan flag stream");
+    }
+
+    // BST nama dengan banyak kunci sama: bstInsert (submit), bstMergeBulk (impor, kunci sama bisa
+    // berada di kedua sisi node) dan bstRemove (edit/undo) harus menyisakan tepat satu node per
+    // aplikasi, terurut, dengan kunci yang sama dengan nama aplikasinya
+    void checkBstEqualKeys() {
+        fs::path root = workDir / "bst";
+        fs::remove_all(root);
+        fs::create_directories(root / "data");
+        fs::path csv = root / "sama.csv";
+        {
+            ofstream file(csv);
+            for (int i = 0; i < 60; ++i) {
+                file << (i % 3 == 0 ? "Andi Wijaya" : "Sama Nama") << ",Jl. Impor " << i << ",Bandung\n";
+            }
+        }
+
+        bool ordered = true, complete = true, formatKept = true, pagesMatch = true;
+        size_t total = 0;
+        quiet([&]() {
+            KtpSystem system(root.string());
+            vector<string> ids;
+            for (int i = 0; i < 8; ++i) ids.push_back(system.submitApplication("Sama Nama", "Jl. Submit " + to_string(i), "Bandung"));
+
+            streamsize precision = cout.precision();
+            ios::fmtflags flags = cout.flags();
+            system.importApplications(csv.string());
+            formatKept = cout.precision() == precision && cout.flags() == flags;
+
+            for (const auto& app : system.applications()) {
+                if (app.name == "Sama Nama") ids.push_back(app.id);
+            }
+            // Edit sebagian ke nama lain lalu batalkan sebagian lagi: node dengan kunci sama dihapus
+            // dari kedua sisi pohon dan disisipkan kembali
+            for (size_t i = 0; i < ids.size(); i += 2) {
+                system.editApplication(ids[i], i % 4 == 0 ? "Zaenal Arifin" : "Budi Sama", "Jl. Edit", "Bandung");
+            }
+            for (size_t i = 0; i < ids.size(); i += 6) {
+                system.undoRevision(ids[i]);
+            }
+
+            vector<Applicant> byName = system.listApplications("name");
+            total = system.applications().size();
+            unordered_set<string> seen;
+            for (size_t i = 0; i < byName.size(); ++i) {
+                if (i > 0 && byName[i].name < byName[i - 1].name) ordered = false;
+                const Applicant* current = system.findApplication(byName[i].id);
+                if (current == nullptr || current->name != byName[i].name || !seen.insert(byName[i].id).second) {
+                    complete = false;
+                }
+            }
+            if (seen.size() != total) complete = false;
+
+            // Halaman harus sama dengan potongan daftar lengkap, termasuk di batas offset/limit
+            for (string sortBy : {"queue", "name", "region", "time", "status"}) {
+                vector<Applicant> full = system.listApplications(sortBy);
+                for (size_t offset : {size_t(0), size_t(7), full.size() - 3, full.size() + 5}) {
+                    ApplicationPage page = system.listApplications(sortBy, offset, 10);
+                    size_t begin = min(offset, full.size());
+                    size_t end = min(begin + 10, full.size());
+                    bool same = page.total == full.size() && page.applications.size() == end - begin;
+                    for (size_t i = begin; same && i < end; ++i) same = page.applications[i - begin].id == full[i].id;
+                    if (!same) pagesMatch = false;
+                }
+            }
+        });
+        check(formatKept, "impor: presisi dan flag cout tidak berubah");
+        check(ordered, "BST kunci sama: traversal in-order terurut menurut nama");
+        check(complete, "BST kunci sama: tepat satu node per aplikasi (" + to_string(total) + ") setelah impor, edit dan undo");
+        check(pagesMatch, "listApplications: halaman offset/limit sama dengan potongan daftar lengkap");
+        fs::remove_all(root);
+    }
+
+#ifdef KTP_CAPACITY_MODE
+    // File spill revisi: instance kedua pada direktori yang sama tidak menimpa file milik instance
+    // pertama, edit/undo berulang tidak membuat file tumbuh tanpa batas (kompaksi), dan revisi
+    // tetap terbaca benar lewat undo maupun snapshot setelah kompaksi
+    void checkSpillFile() {
+        fs::path root = workDir / "spill";
+        fs::remove_all(root);
+        fs::create_directories(root / "data");
+
+        bool undoOrder = true, reloaded = true;
+        uint64_t spillBytes = 0;
+        quiet([&]() {
+            KtpSystem system(root.string());
+            // Revisi churn yang sudah dilepas menempati awal file, sehingga revisi id berada di offset
+            // yang berbeda dari yang akan ditulis instance kedua saat memuat snapshot
+            string churn = system.submitApplication("Churn", string(400, 'x'), "Bandung");
+            system.editApplication(churn, "Churn", "Jl. Churn", "Bandung");
+            system.undoRevision(churn);
+            string id = system.submitApplication("Rina Asli", "Jl. Awal 1", "Bandung");
+            for (const char* name : {"Rina Satu", "Rina Dua", "Rina Tiga"}) system.editApplication(id, name, "Jl. Awal 1", "Bandung");
+            system.saveData();
+            { KtpSystem other(root.string()); }
+
+            // Setiap edit menyimpan baris lama (alamat 400 byte) ke spill; undo melepasnya
+            for (int i = 0; i < 6000; ++i) {
+                system.editApplication(churn, "Churn " + to_string(i % 7), "Jl. Churn", "Bandung");
+                system.undoRevision(churn);
+            }
+            spillBytes = system.memoryReport().spillFileBytes;
+            system.saveData();
+
+            {
+                KtpSystem reloadedSystem(root.string());
+                reloaded = reloadedSystem.revisionCount(id) == 3 && reloadedSystem.undoRevision(id) &&
+                           reloadedSystem.findApplication(id)->name == "Rina Dua";
+            }
+            for (const char* expected : {"Rina Dua", "Rina Satu", "Rina Asli"}) {
+                if (!system.undoRevision(id) || system.findApplication(id)->name != expected) undoOrder = false;
+            }
+        });
+        check(spillBytes <= 2 * SpillFile::MIN_COMPACT_GARBAGE,
+              "spill: file dipadatkan setelah 6000 edit/undo (" + to_string(spillBytes) + " byte)");
+        check(undoOrder, "spill: undo membaca revisi yang benar setelah instance lain dibuka dan kompaksi");
+        check(reloaded, "spill: snapshot setelah kompaksi memuat revisi yang benar");
+        bool leftover = false;
+        for (const auto& entry : fs::directory_iterator(root / "data")) {
+            if (entry.path().string().find(".spill") != string::npos) leftover = true;
+        }
+        check(!leftover, "spill: tidak ada file spill tersisa setelah semua instance ditutup");
+        fs::remove_all(root);
+    }
+#endif
+
+    // Pemohon ganda: normalisasi UTF-8, laporan batas bucket, dan cluster union-find yang transitif
+    // (A~B lewat bucket nama, B~C lewat bucket alamat, A dan C tidak berbagi bucket)
+    void checkDuplicates() {
+        check(normalizeName("\xC3\x96mer \xC3\x87" "elik") == "\xC3\x87" "elik \xC3\x96" "mer",
+              "dedup: huruf UTF-8 dipertahankan dalam token nama");
+
+        DedupIndex index;
+        for (int i = 0; i < 80; ++i) index.add("B-" + to_string(i), "Budi Santoso", "Jl. Gatot " + to_string(i), "Bandung");
+        size_t skipped = 0;
+        index.findMatches("Budi Santoso", "Jl. Lain 1", "Bandung", "", &skipped);
+        check(skipped == 80 - DedupIndex::MAX_CANDIDATES_PER_BUCKET,
+              "dedup: kandidat yang melewati batas bucket dilaporkan (" + to_string(skipped) + ")");
+
+        fs::path root = workDir / "dedup";
+        fs::remove_all(root);
+        fs::create_directories(root / "data");
+        vector<vector<string>> clusters;
+        vector<string> ids;
+        quiet([&]() {
+            KtpSystem system(root.string());
+            ids.push_back(system.submitApplication("Budi Santoso", "Jl. Merdeka 10", "Bandung"));
+            ids.push_back(system.submitApplication("Santoso Budi", "Jalan Merdeka No. 10 RT 2", "Kota Bandung"));
+            ids.push_back(system.submitApplication("Budi Santosa", "Jln Merdeka No 010 RT 02", "Bandung"));
+            ids.push_back(system.submitApplication("Siti Aminah", "Jl. Asia Afrika 5", "Bandung"));
+            ids.push_back(system.submitApplication("Siti Aminah", "Jl. Sudirman 7", "Jakarta"));
+            ids.push_back(system.submitApplication("Aminah Siti", "Jalan Sudirman No. 7", "Jakarta"));
+            clusters = system.duplicateClusters();
+        });
+        auto sorted = [](vector<string> group) {
+            sort(group.begin(), group.end());
+            return group;
+        };
+        vector<vector<string>> expected = {sorted({ids[0], ids[1], ids[2]}), sorted({ids[4], ids[5]})};
+        check(clusters == expected, "dedup: union-find menggabungkan pasangan menjadi " + to_string(clusters.size()) + " cluster");
+        fs::remove_all(root);
+    }
+
+    // sortByKeys harus menghasilkan urutan yang sama persis dengan std::stable_sort dengan
+    // pembanding tuple: urutan multi-kunci benar dan item dengan kunci sama tetap dalam urutan
+    // input. Data sengaja penuh kunci kembar, nama dengan prefiks panjang yang sama (> 16 byte),
+    // string kosong, byte non-ASCII (UTF-8), dan waktu negatif.
+    void checkSortKernels() {
+        ApplicantGenerator gen(77);
+        const vector<string> sharedPrefix = {"Muhammad Abdurrahman Saputra", "Muhammad Abdurrahman Santoso",
+                                             "Muhammad Abdurrahman", "", "\xC3\x96mer \xC3\x87" "elik"};
+        vector<Applicant> input;
+        for (size_t i = 0; i < 5000; ++i) {
+            string region = i % 11 == 0 ? "" : gen.region();
+            string name = i % 5 == 0 ? sharedPrefix[i % sharedPrefix.size()] : gen.name();
+            time_t submitted = static_cast<time_t>(gen.index(60)) - 30;
+            input.push_back({"ID-" + to_string(i), name, "", region, submitted, gen.status()});
+        }
+
+        auto identity = [](const Applicant& app) -> const Applicant& { return app; };
+        auto sameOrder = [](const vector<Applicant>& a, const vector<Applicant>& b) {
+            if (a.size() != b.size()) return false;
+            for (size_t i = 0; i < a.size(); ++i) {
+                if (a[i].id != b[i].id) return false;
+            }
+            return true;
+        };
+        auto expectSame = [&](const string& what, auto comparator, auto kernel) {
+            vector<Applicant> expected = input;
+            vector<Applicant> actual = input;
+            stable_sort(expected.begin(), expected.end(), comparator);
+            kernel(actual);
+            check(sameOrder(expected, actual), "sort: " + what + " sama dengan stable_sort");
+        };
+
+        expectSame("(region, status, name)",
+                   [](const Applicant& a, const Applicant& b) {
+                       return tie(a.region, a.status, a.name) < tie(b.region, b.status, b.name);
+                   },
+                   [&](vector<Applicant>& items) { sortByKeys<ktpsort::ByRegion, ktpsort::ByStatus, ktpsort::ByName>(items, identity); });
+        expectSame("(region, waktu)",
+                   [](const Applicant& a, const Applicant& b) {
+                       return tie(a.region, a.submissionTime) < tie(b.region, b.submissionTime);
+                   },
+                   [&](vector<Applicant>& items) { sortByKeys<ktpsort::ByRegion, ktpsort::ByTime>(items, identity); });
+        expectSame("nama (prefiks panjang sama)",
+                   [](const Applicant& a, const Applicant& b) { return a.name < b.name; },
+                   [&](vector<Applicant>& items) { sortByKeys<ktpsort::ByName>(items, identity); });
+        expectSame("waktu (radix, termasuk negatif)",
+                   [](const Applicant& a, const Applicant& b) { return a.submissionTime < b.submissionTime; },
+                   [&](vector<Applicant>& items) { sortByKeys<ktpsort::ByTime>(items, identity); });
+        // Kunci yang hanya berbeda di byte NUL akhir punya prefiks identik; urutan harus ditentukan
+        // kunci ini sendiri, bukan jatuh ke kunci berikutnya
+        vector<Applicant> nulKeys;
+        const vector<string> nulRegions = {string("Ban\0\0", 5), string("Ban\0", 4), string("Ban", 3),
+                                           string("Bandung\0\0z", 10), string("Bandung\0\0", 9), string("Bandung\0", 8)};
+        for (size_t i = 0; i < nulRegions.size(); ++i) {
+            nulKeys.push_back({"NUL-" + to_string(i), "", "", nulRegions[i], static_cast<time_t>(i), "Pending"});
+        }
+        vector<Applicant> nulExpected = nulKeys, nulActual = nulKeys;
+        stable_sort(nulExpected.begin(), nulExpected.end(), [](const Applicant& a, const Applicant& b) {
+            return tie(a.region, a.submissionTime) < tie(b.region, b.submissionTime);
+        });
+        sortByKeys<ktpsort::ByRegion, ktpsort::ByTime>(nulActual, identity);
+        check(sameOrder(nulExpected, nulActual), "sort: kunci yang hanya berbeda di byte NUL akhir tetap terurut");
+
+        expectSame("(status, nama) 137 pertama",
+                   [](const Applicant& a, const Applicant& b) { return tie(a.status, a.name) < tie(b.status, b.name); },
+                   [&](vector<Applicant>& items) {
+                       vector<Applicant> head = items;
+                       selectFirstByKeys<ktpsort::ByStatus, ktpsort::ByName>(head, 137, identity);
+                       sortByKeys<ktpsort::ByStatus, ktpsort::ByName>(items, identity);
+                       bool prefix = head.size() == 137;
+                       for (size_t i = 0; prefix && i < head.size(); ++i) prefix = head[i].id == items[i].id;
+                       if (!prefix) items.clear();
+                   });
+    }
+
+    // Snapshot delta (hanya ID yang berubah digabung ke file sebelumnya) harus menghasilkan state
+    // yang sama dengan yang ada di memori, termasuk setelah sort (snapshot penuh) dan undo
+    void checkDeltaSnapshot() {
+        fs::path root = workDir / "delta";
+        fs::remove_all(root);
+        vector<Applicant> expected;
+        map<string, size_t> expectedRevisions;
+        auto capture = [&](const KtpSystem& system) {
+            expected = system.listApplications("queue");
+            expectedRevisions.clear();
+            for (const auto& app : expected) expectedRevisions[app.id] = system.revisionCount(app.id);
+        };
+        auto sameAsExpected = [&](const KtpSystem& system) {
+            vector<Applicant> actual = system.listApplications("queue");
+            if (actual.size() != expected.size()) return false;
+            for (size_t i = 0; i < actual.size(); ++i) {
+                const Applicant& a = actual[i];
+                const Applicant& b = expected[i];
+                if (a.id != b.id || a.name != b.name || a.address != b.address || a.region != b.region ||
+                    a.submissionTime != b.submissionTime || a.status != b.status ||
+                    system.revisionCount(a.id) != expectedRevisions[a.id]) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        ApplicantGenerator gen(2024);
+        quiet([&]() {
+            KtpSystem system(root.string());
+            vector<string> ids;
+            for (int round = 0; round < 6; ++round) {
+                for (int i = 0; i < 20; ++i) {
+                    string region = gen.region();
+                    ids.push_back(system.submitApplication(gen.name(), gen.address(region), region));
+                }
+                for (int i = 0; i < 10; ++i) {
+                    const string& id = ids[gen.index(ids.size())];
+                    string region = gen.region();
+                    system.editApplication(id, gen.name(), gen.address(region), region);
+                    if (i % 3 == 0) system.undoRevision(id);
+                    system.processVerification(ids[gen.index(ids.size())]);
+                }
+                if (round == 3) system.sortByRegion();
+                system.saveData();
+            }
+            capture(system);
+        });
+        bool reloaded = false;
+        quiet([&]() {
+            KtpSystem system(root.string());
+            reloaded = sameAsExpected(system);
+        });
+        check(reloaded, "snapshot delta: hasil muat ulang sama dengan state di memori (" + to_string(expected.size()) + " aplikasi)");
+        fs::remove_all(root);
+    }
+
+    // Crash di setiap titik protokol commit KtpSnapshotStore harus berakhir di satu generasi utuh
+    void checkSnapshotRecovery() {
+        fs::path root = workDir / "recovery";
+        fs::path data = root / "data";
+        fs::remove_all(root);
+        fs::path apps = data / "ktp_applications.txt";
+        fs::path revisions = data / "ktp_revisions.txt";
+        fs::path manifest = data / "ktp_manifest.txt";
+        fs::path saved = root / "saved";
+
+        // Generasi 1: satu aplikasi. Generasi 2: aplikasi kedua dan satu edit (satu revisi).
+        string first, second;
+        quiet([&]() {
+            KtpSystem system(root.string());
+            first = system.submitApplication("Budi Santoso", "Jl. Merdeka 1", "Bandung");
+            system.saveData();
+        });
+        fs::create_directories(saved);
+        copyOver(apps, saved / "apps.1");
+        copyOver(revisions, saved / "revisions.1");
+        copyOver(manifest, saved / "manifest.1");
+        quiet([&]() {
+            KtpSystem system(root.string());
+            second = system.submitApplication("Siti Aminah", "Jl. Asia Afrika 2", "Bandung");
+            system.editApplication(first, "Budi S.", "Jl. Merdeka 1", "Bandung");
+            system.saveData();
+        });
+        copyOver(apps, saved / "apps.2");
+        copyOver(revisions, saved / "revisions.2");
+        copyOver(manifest, saved / "manifest.2");
+
+        auto loadsGeneration = [&](int generation) {
+            bool ok = false;
+            quiet([&]() {
+                KtpSystem system(root.string());
+                const Applicant* edited = system.findApplication(first);
+                if (generation == 1) {
+                    ok = system.applications().size() == 1 && edited != nullptr && edited->name == "Budi Santoso" &&
+                         system.revisionCount(first) == 0;
+                } else {
+                    ok = system.applications().size() == 2 && edited != nullptr && edited->name == "Budi S." &&
+                         system.findApplication(second) != nullptr && system.revisionCount(first) == 1;
+                }
+            });
+            return ok && !hasTmpFiles(data);
+        };
+
+        // Crash setelah titik commit, sebelum file data di-rename: roll-forward ke generasi 2
+        copyOver(saved / "manifest.2", manifest);
+        copyOver(saved / "apps.2", KtpSnapshotStore::tmpPath(apps));
+        copyOver(saved / "revisions.2", KtpSnapshotStore::tmpPath(revisions));
+        copyOver(saved / "apps.1", apps);
+        copyOver(saved / "revisions.1", revisions);
+        check(loadsGeneration(2), "snapshot: crash sebelum rename file data di-roll-forward");
+
+        // Crash di antara dua rename file data: file yang tersisa di .tmp diselesaikan
+        copyOver(saved / "apps.2", apps);
+        copyOver(saved / "revisions.2", KtpSnapshotStore::tmpPath(revisions));
+        copyOver(saved / "revisions.1", revisions);
+        check(loadsGeneration(2), "snapshot: crash di antara rename file data diselesaikan");
+
+        // Crash sebelum titik commit: manifest.tmp terpotong dan file .tmp setengah jadi dibuang
+        copyOver(saved / "manifest.1", manifest);
+        copyOver(saved / "apps.1", apps);
+        copyOver(saved / "revisions.1", revisions);
+        ofstream(KtpSnapshotStore::tmpPath(manifest)) << "generation 3\nfile ktp_appli";
+        ofstream(KtpSnapshotStore::tmpPath(apps)) << "Bandung-1\tSetengah";
+        check(loadsGeneration(1), "snapshot: manifest.tmp terpotong dibuang, generasi lama dipakai");
+
+        // Tanpa sisa crash, generasi terakhir dimuat apa adanya
+        copyOver(saved / "manifest.2", manifest);
+        copyOver(saved / "apps.2", apps);
+        copyOver(saved / "revisions.2", revisions);
+        check(loadsGeneration(2), "snapshot: generasi 2 utuh dimuat apa adanya");
+
+        fs::remove_all(root);
+    }
+
+public:
+    explicit SelfCheck(const fs::path& dir) : workDir(dir / "self_check") {}
+
+    // Mengembalikan true bila semua pemeriksaan lolos
+    bool run() {
+        fs::create_directories(workDir);
+        checkSnapshotRecovery();
+        checkDeltaSnapshot();
+        checkSortKernels();
+        checkMetricsFormat();
+        checkJsonControlCharacters();
+        checkBstEqualKeys();
+        checkDuplicates();
+#ifdef KTP_CAPACITY_MODE
+        checkSpillFile();
+#endif
+        fs::remove_all(workDir);
+        cout << passed << " lolos, " << failed << " gagal." << endl;
+        return failed == 0;
+    }
+};
+
+static vector<size_t> parseSizes(const string& arg) {
+    vector<size_t> sizes;
+    for (const auto& token : split(arg, ',')) {
+        if (!token.empty()) {
+            sizes.push_back(static_cast<size_t>(stoull(token)));
+        }
+    }
+    return sizes;
+}
+
+int main(int argc, char* argv[]) {
+    vector<size_t> sizes = {10000, 1000000, 10000000};
+    size_t ops = 0;
+    string outPath;
+    bool selfCheck = false;
+    fs::path workDir = fs::temp_directory_path() / "ktp_benchmark";
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc) {
+            sizes = parseSizes(argv[++i]);
+        } else if (arg == "--ops" && i + 1 < argc) {
+            ops = static_cast<size_t>(stoull(argv[++i]));
+        } else if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (arg == "--workdir" && i + 1 < argc) {
+            workDir = argv[++i];
+        } else if (arg == "--self-check") {
+            selfCheck = true;
+        } else {
+            cerr << "Penggunaan: " << argv[0]
+                 << " [--sizes 10000,1000000,10000000] [--ops N] [--out file.jsonl] [--workdir dir] [--self-check]" << endl;
+            return 1;
+        }
+    }
+
+    if (selfCheck) {
+        return SelfCheck(workDir).run() ? 0 : 1;
+    }
+
+    ofstream outFile;
+    if (!outPath.empty()) {
+        outFile.open(outPath);
+        if (!outFile.is_open()) {
+            cerr << "Tidak bisa membuka file output: " << outPath << endl;
+            return 1;
+        }
+    }
+    Benchmark bench(outPath.empty() ? cout : outFile);
+
+    // Catatan: peak_rss_kb adalah high-water mark proses, jadi jalankan satu ukuran per proses
+    // (--sizes N) bila ingin angka RSS yang terpisah untuk setiap ukuran.
+    for (size_t size : sizes) {
+        bench.run(workDir, size, ops);
+    }
+    return 0;
+}
@@ -0,0 +1,393 @@
+// Deteksi pemohon ganda (orang yang sama mengajukan dengan ID berbeda)
+//
+// - Nama, alamat dan region dinormalisasi: huruf ASCII kecil, tanda baca jadi spasi, spasi dirapatkan,
+//   singkatan umum diperluas ("Jl." -> "jalan", "Moh." -> "muhammad"), kata "No."/"Nomor" dan nol
+//   di depan angka dibuang ("No. 5, RT 01" = "5 RT 1"), dan token nama diurutkan sehingga "Santoso Budi" = "Budi Santoso".
+// - Blocking: setiap aplikasi masuk ke dua bucket hash, (region, nama) dan (region, alamat).
+//   Kandidat hanya dicari di bucket yang sama lalu dicek dengan kemiripan bigram (Dice),
+//   sehingga pengecekan saat submit/edit O(1) expected. Bucket yang lebih besar dari
+//   MAX_CANDIDATES_PER_BUCKET hanya dicek sebagian; jumlah kandidat yang dilewati dilaporkan.
+// - Mode batch (findDuplicateClusters) membagi bucket ke beberapa thread berdasarkan hash kunci,
+//   lalu menggabungkan pasangan yang cocok dengan union-find menjadi cluster.
+#ifndef KTP_DEDUP_H
+#define KTP_DEDUP_H
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ktp_memory.h"
+
+struct NormalizedApplicant {
+    std::string name;    // Token terurut
+    std::string address;
+    std::string region;
+    uint64_t nameKey = 0;    // Hash (region, nama) untuk blocking
+    uint64_t addressKey = 0; // Hash (region, alamat) untuk blocking
+};
+
+struct DedupEntry {
+    std::string id;
+    NormalizedApplicant normalized;
+};
+
+struct DuplicateMatch {
+    std::string id;
+    double score; // Rata-rata kemiripan nama dan alamat, 0..1
+};
+
+namespace ktpdedup {
+
+struct Abbreviation {
+    std::string_view from;
+    std::string_view to; // Kosong = token dibuang
+};
+
+// Memecah text menjadi token alfanumerik huruf kecil (nol di depan angka dibuang), memperluas
+// singkatan, lalu menggabungkannya dengan satu spasi. Token disimpan sebagai string_view ke satu
+// buffer sehingga tidak ada alokasi per token. Hanya ASCII yang dikenali sebagai huruf/angka/tanda
+// baca; byte non-ASCII (UTF-8, mis. "Ö") dianggap bagian dari token dan disalin tanpa case folding,
+// sehingga "Ömer" tidak menyusut menjadi "mer" dan hasilnya tidak bergantung pada locale.
+template <size_t N>
+std::string normalizeTokens(const std::string& text, const Abbreviation (&table)[N], bool sortTokens) {
+    std::string lower(text.size(), ' ');
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x80) {
+            lower[i] = text[i];
+        } else if (std::isalnum(c)) {
+            lower[i] = static_cast<char>(std::tolower(c));
+        }
+    }
+
+    std::vector<std::string_view> parts;
+    std::string_view rest(lower);
+    while (!rest.empty()) {
+        size_t start = rest.find_first_not_of(' ');
+        if (start == std::string_view::npos) break;
+        size_t end = rest.find(' ', start);
+        std::string_view token = rest.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+        rest = end == std::string_view::npos ? std::string_view() : rest.substr(end);
+
+        if (token.size() > 1 && token[0] == '0' &&
+            std::all_of(token.begin(), token.end(), [](char d) { return std::isdigit(static_cast<unsigned char>(d)); })) {
+            size_t first = token.find_first_not_of('0');
+            token = first == std::string_view::npos ? token.substr(token.size() - 1) : token.substr(first);
+        }
+        for (const auto& abbreviation : table) {
+            if (token == abbreviation.from) {
+                token = abbreviation.to;
+                break;
+            }
+        }
+        if (!token.empty()) parts.push_back(token);
+    }
+    if (sortTokens) std::sort(parts.begin(), parts.end());
+
+    std::string result;
+    result.reserve(text.size());
+    for (const auto& part : parts) {
+        if (!result.empty()) result += ' ';
+        result.append(part.data(), part.size());
+    }
+    return result;
+}
+
+} // namespace ktpdedup
+
+inline std::string normalizeName(const std::string& name) {
+    static constexpr ktpdedup::Abbreviation ABBREVIATIONS[] = {
+        {"muh", "muhammad"}, {"moh", "muhammad"}, {"mhd", "muhammad"}, {"moch", "muhammad"},
+        {"mochammad", "muhammad"}, {"mohammad", "muhammad"}, {"muhamad", "muhammad"}, {"mohamad", "muhammad"},
+        {"abd", "abdul"}, {"st", "siti"},
+    };
+    return ktpdedup::normalizeTokens(name, ABBREVIATIONS, true);
+}
+
+inline std::string normalizeAddress(const std::string& address) {
+    static constexpr ktpdedup::Abbreviation ABBREVIATIONS[] = {
+        {"jl", "jalan"}, {"jln", "jalan"}, {"gg", "gang"}, {"no", ""}, {"nomor", ""}, {"kel", "kelurahan"},
+        {"kec", "kecamatan"}, {"kab", "kabupaten"}, {"komp", "komplek"}, {"kompl", "komplek"},
+        {"perum", "perumahan"}, {"blk", "blok"}, {"ds", "desa"},
+    };
+    return ktpdedup::normalizeTokens(address, ABBREVIATIONS, false);
+}
+
+// "Kota Bandung", "Kab. Bandung" dan "bandung" dianggap region yang sama
+inline std::string normalizeRegion(const std::string& region) {
+    static constexpr ktpdedup::Abbreviation NO_ABBREVIATIONS[] = {{"", ""}};
+    std::string result = ktpdedup::normalizeTokens(region, NO_ABBREVIATIONS, false);
+    for (const char* prefix : {"kota ", "kab ", "kabupaten "}) {
+        size_t length = std::char_traits<char>::length(prefix);
+        if (result.size() > length && result.compare(0, length, prefix) == 0) return result.substr(length);
+    }
+    return result;
+}
+
+// Tabrakan hash hanya menambah kandidat yang kemudian ditolak duplicateScore
+inline uint64_t blockKey(const std::string& region, const std::string& value) {
+    uint64_t seed = std::hash<std::string>()(region);
+    return seed ^ (std::hash<std::string>()(value) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+inline NormalizedApplicant normalizeApplicant(const std::string& name, const std::string& address, const std::string& region) {
+    NormalizedApplicant result{normalizeName(name), normalizeAddress(address), normalizeRegion(region)};
+    result.nameKey = blockKey(result.region, result.name);
+    result.addressKey = blockKey(result.region, result.address) ^ 1; // Berbeda dari nameKey walau teksnya sama
+    return result;
+}
+
+// Koefisien Dice atas bigram karakter: 2 * |A ∩ B| / (|A| + |B|)
+inline double bigramSimilarity(const std::string& a, const std::string& b) {
+    if (a == b) return 1.0;
+    if (a.size() < 2 || b.size() < 2) return 0.0;
+    auto bigrams = [](const std::string& s) {
+        std::vector<uint16_t> result;
+        result.reserve(s.size() - 1);
+        for (size_t i = 0; i + 1 < s.size(); ++i) {
+            result.push_back(static_cast<uint16_t>((static_cast<unsigned char>(s[i]) << 8) | static_cast<unsigned char>(s[i + 1])));
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+    std::vector<uint16_t> ba = bigrams(a), bb = bigrams(b);
+    size_t i = 0, j = 0, common = 0;
+    while (i < ba.size() && j < bb.size()) {
+        if (ba[i] == bb[j]) {
+            ++common; ++i; ++j;
+        } else if (ba[i] < bb[j]) {
+            ++i;
+        } else {
+            ++j;
+        }
+    }
+    return 2.0 * static_cast<double>(common) / static_cast<double>(ba.size() + bb.size());
+}
+
+// Dua entri dianggap kemungkinan duplikat bila region-nya sama, nama sangat mirip dan alamat mirip.
+// Mengembalikan skor (> 0) atau 0 bila bukan duplikat.
+inline double duplicateScore(const NormalizedApplicant& a, const NormalizedApplicant& b) {
+    static constexpr double NAME_THRESHOLD = 0.8;
+    static constexpr double ADDRESS_THRESHOLD = 0.7;
+    if (a.region != b.region || a.name.empty() || a.address.empty()) return 0.0;
+    double nameScore = bigramSimilarity(a.name, b.name);
+    if (nameScore < NAME_THRESHOLD) return 0.0;
+    double addressScore = bigramSimilarity(a.address, b.address);
+    if (addressScore < ADDRESS_THRESHOLD) return 0.0;
+    return (nameScore + addressScore) / 2.0;
+}
+
+// Indeks blocking untuk pengecekan duplikat saat submit/edit. Bucket menyimpan pointer ke elemen
+// entries (alamat elemen unordered_map stabil walau terjadi rehash), sehingga ID tidak disalin.
+class DedupIndex {
+public:
+    // Bucket yang sangat besar (mis. alamat kosong/umum) hanya dicek sebagian agar tetap O(1)
+    static constexpr size_t MAX_CANDIDATES_PER_BUCKET = 64;
+
+    void clear() {
+        entries.clear();
+        blocks.clear();
+    }
+
+    void reserve(size_t count) {
+        entries.reserve(count);
+        blocks.reserve(count * 2);
+    }
+
+    size_t size() const { return entries.size(); }
+
+    void add(const std::string& id, const std::string& name, const std::string& address, const std::string& region) {
+        add(id, normalizeApplicant(name, address, region));
+    }
+
+    // Untuk data yang sudah dinormalisasi (mis. secara paralel saat memuat file)
+    void add(const std::string& id, NormalizedApplicant normalized) {
+        remove(id);
+        auto inserted = entries.emplace(id, std::move(normalized)).first;
+        const Entry* entry = &*inserted;
+        blocks[entry->second.nameKey].push_back(entry);
+        blocks[entry->second.addressKey].push_back(entry);
+    }
+
+    void remove(const std::string& id) {
+        auto it = entries.find(id);
+        if (it == entries.end()) return;
+        eraseFromBucket(it->second.nameKey, &*it);
+        eraseFromBucket(it->second.addressKey, &*it);
+        entries.erase(it);
+    }
+
+    // Kemungkinan duplikat untuk data (name, address, region), terurut skor menurun.
+    // excludeId dipakai saat mengecek aplikasi yang sudah ada di indeks. Bila skipped diisi,
+    // berisi jumlah kandidat yang tidak diperiksa karena bucket-nya melebihi batas.
+    std::vector<DuplicateMatch> findMatches(const std::string& name, const std::string& address,
+                                            const std::string& region, const std::string& excludeId = "",
+                                            size_t* skipped = nullptr) const {
+        NormalizedApplicant probe = normalizeApplicant(name, address, region);
+        std::vector<DuplicateMatch> matches;
+        std::vector<const Entry*> seen;
+        if (skipped != nullptr) *skipped = 0;
+        auto scan = [&](uint64_t key) {
+            auto bucket = blocks.find(key);
+            if (bucket == blocks.end()) return;
+            size_t checked = 0;
+            for (const Entry* entry : bucket->second) {
+                if (checked++ == MAX_CANDIDATES_PER_BUCKET) {
+                    if (skipped != nullptr) *skipped += bucket->second.size() - MAX_CANDIDATES_PER_BUCKET;
+                    break;
+                }
+                if (entry->first == excludeId || std::find(seen.begin(), seen.end(), entry) != seen.end()) continue;
+                seen.push_back(entry);
+                double score = duplicateScore(probe, entry->second);
+                if (score > 0.0) matches.push_back({entry->first, score});
+            }
+        };
+        scan(probe.nameKey);
+        scan(probe.addressKey);
+        std::sort(matches.begin(), matches.end(), [](const DuplicateMatch& a, const DuplicateMatch& b) { return a.score > b.score; });
+        return matches;
+    }
+
+    // Perkiraan byte heap indeks: tabel entri beserta string ternormalisasi, dan bucket blocking
+    size_t memoryBytes() const {
+        size_t bytes = ktpmem::hashTableBytes(entries) + ktpmem::hashTableBytes(blocks);
+        for (const auto& entry : entries) {
+            bytes += ktpmem::stringHeapBytes(entry.first) + ktpmem::stringHeapBytes(entry.second.name) +
+                     ktpmem::stringHeapBytes(entry.second.address) + ktpmem::stringHeapBytes(entry.second.region);
+        }
+        for (const auto& bucket : blocks) {
+            bytes += ktpmem::vectorBytes(bucket.second);
+        }
+        return bytes;
+    }
+
+    // Salinan semua entri ternormalisasi (untuk findDuplicateClusters)
+    std::vector<DedupEntry> snapshot() const {
+        std::vector<DedupEntry> result;
+        result.reserve(entries.size());
+        for (const auto& entry : entries) result.push_back({entry.first, entry.second});
+        return result;
+    }
+
+private:
+    using Entry = std::pair<const std::string, NormalizedApplicant>;
+
+    std::unordered_map<std::string, NormalizedApplicant> entries;
+    // Bucket nama dan alamat dalam satu tabel; kuncinya dipisahkan oleh normalizeApplicant
+    std::unordered_map<uint64_t, std::vector<const Entry*>> blocks;
+
+    void eraseFromBucket(uint64_t key, const Entry* entry) {
+        auto bucket = blocks.find(key);
+        if (bucket == blocks.end()) return;
+        auto& members = bucket->second;
+        auto pos = std::find(members.begin(), members.end(), entry);
+        if (pos != members.end()) {
+            *pos = members.back();
+            members.pop_back();
+        }
+        if (members.empty()) blocks.erase(bucket);
+    }
+};
+
+// Union-find dengan path halving dan union by size
+class DisjointSet {
+public:
+    explicit DisjointSet(size_t count) : parent(count), size(count, 1) {
+        for (size_t i = 0; i < count; ++i) parent[i] = static_cast<uint32_t>(i);
+    }
+
+    uint32_t find(uint32_t x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    void unite(uint32_t a, uint32_t b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return;
+        if (size[a] < size[b]) std::swap(a, b);
+        parent[b] = a;
+        size[a] += size[b];
+    }
+
+private:
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> size;
+};
+
+// Mencari semua cluster duplikat (ukuran >= 2) secara paralel. Setiap thread memegang shard
+// bucket berdasarkan hash kunci, membandingkan pasangan di dalam bucket-nya, lalu pasangan yang
+// cocok digabung dengan union-find. Bucket besar dibandingkan dengan jendela geser (sorted
+// neighborhood) agar tidak kuadratik.
+inline std::vector<std::vector<std::string>> findDuplicateClusters(const std::vector<DedupEntry>& entries,
+                                                                    size_t threadCount = 0) {
+    static constexpr size_t FULL_COMPARE_LIMIT = 128;
+    static constexpr size_t WINDOW = 32;
+    if (threadCount == 0) {
+        threadCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), 16));
+    }
+
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> edges(threadCount);
+    auto compareBlock = [&](std::vector<uint32_t>& block, bool byName, std::vector<std::pair<uint32_t, uint32_t>>& out) {
+        if (block.size() > FULL_COMPARE_LIMIT) {
+            // Urutkan menurut field lain sehingga yang mirip berdekatan, lalu bandingkan dalam jendela
+            std::sort(block.begin(), block.end(), [&](uint32_t a, uint32_t b) {
+                const NormalizedApplicant& na = entries[a].normalized;
+                const NormalizedApplicant& nb = entries[b].normalized;
+                return byName ? na.address < nb.address : na.name < nb.name;
+            });
+        }
+        for (size_t i = 0; i < block.size(); ++i) {
+            size_t end = block.size() > FULL_COMPARE_LIMIT ? std::min(block.size(), i + 1 + WINDOW) : block.size();
+            for (size_t j = i + 1; j < end; ++j) {
+                if (duplicateScore(entries[block[i]].normalized, entries[block[j]].normalized) > 0.0) out.emplace_back(block[i], block[j]);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t shard = 0; shard < threadCount; ++shard) {
+        workers.emplace_back([&, shard]() {
+            std::unordered_map<uint64_t, std::vector<uint32_t>> nameBlocks, addressBlocks;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                const NormalizedApplicant& n = entries[i].normalized;
+                if (n.nameKey % threadCount == shard) nameBlocks[n.nameKey].push_back(static_cast<uint32_t>(i));
+                if (n.addressKey % threadCount == shard) addressBlocks[n.addressKey].push_back(static_cast<uint32_t>(i));
+            }
+            for (auto& block : nameBlocks) compareBlock(block.second, true, edges[shard]);
+            for (auto& block : addressBlocks) compareBlock(block.second, false, edges[shard]);
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    DisjointSet sets(entries.size());
+    for (const auto& shardEdges : edges) {
+        for (const auto& edge : shardEdges) sets.unite(edge.first, edge.second);
+    }
+
+    std::unordered_map<uint32_t, std::vector<std::string>> byRoot;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        byRoot[sets.find(static_cast<uint32_t>(i))].push_back(entries[i].id);
+    }
+    std::vector<std::vector<std::string>> clusters;
+    for (auto& group : byRoot) {
+        if (group.second.size() < 2) continue;
+        std::sort(group.second.begin(), group.second.end());
+        clusters.push_back(std::move(group.second));
+    }
+    std::sort(clusters.begin(), clusters.end(), [](const std::vector<std::string>& a, const std::vector<std::string>& b) {
+        return a.size() != b.size() ? a.size() > b.size() : a.front() < b.front();
+    });
+    return clusters;
+}
+
+#endif // KTP_DEDUP_H
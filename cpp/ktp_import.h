@@ -0,0 +1,100 @@
+// Utilitas impor massal untuk KtpSystem: membaca file TSV/CSV besar secara streaming dalam
+// potongan baris, dan memproses setiap potongan secara paralel dengan beberapa thread.
+//
+// - File .csv memakai koma dengan kutip ganda ala RFC 4180 ("a, b" dan "" untuk tanda kutip);
+//   ekstensi lain dianggap TSV. Field yang memuat baris baru tidak didukung.
+// - Baris pertama dianggap header bila salah satu kolomnya bernama "name".
+#ifndef KTP_IMPORT_H
+#define KTP_IMPORT_H
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Memecah satu baris CSV/TSV. Berbeda dengan split(), field kosong di akhir baris tetap dihitung.
+inline std::vector<std::string> splitImportLine(const std::string& line, char delimiter) {
+    std::vector<std::string> fields;
+    std::string field;
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (delimiter == ',' && c == '"') {
+            if (quoted && i + 1 < line.size() && line[i + 1] == '"') {
+                field += '"';
+                ++i;
+            } else {
+                quoted = !quoted;
+            }
+        } else if (c == delimiter && !quoted) {
+            fields.push_back(field);
+            field.clear();
+        } else {
+            field += c;
+        }
+    }
+    fields.push_back(field);
+    return fields;
+}
+
+inline std::string trimImportField(const std::string& value) {
+    size_t first = value.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) return "";
+    size_t last = value.find_last_not_of(" \t\r\n");
+    return value.substr(first, last - first + 1);
+}
+
+inline char importDelimiterFor(const std::string& path) {
+    std::string ext;
+    size_t dot = path.find_last_of('.');
+    if (dot != std::string::npos) ext = path.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == "csv" ? ',' : '\t';
+}
+
+// Menjalankan fn(begin, end) atas rentang [0, count) yang dibagi rata ke beberapa thread
+template <typename Fn>
+void parallelRanges(size_t count, Fn fn) {
+    size_t threads = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), 16));
+    threads = std::min(threads, std::max<size_t>(1, count / 1024)); // Potongan kecil tidak perlu thread
+    if (threads <= 1) {
+        fn(size_t(0), count);
+        return;
+    }
+    std::vector<std::thread> workers;
+    size_t per = (count + threads - 1) / threads;
+    for (size_t t = 0; t < threads; ++t) {
+        size_t begin = t * per;
+        size_t end = std::min(count, begin + per);
+        if (begin >= end) break;
+        workers.emplace_back([&fn, begin, end]() { fn(begin, end); });
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+// Membaca file per potongan maksimal chunkSize baris. onChunk(lines, firstLineNumber)
+// dipanggil untuk setiap potongan; nomor baris dimulai dari 1.
+template <typename OnChunk>
+bool readLineChunks(const std::string& path, size_t chunkSize, OnChunk onChunk) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+    std::vector<std::string> lines;
+    lines.reserve(chunkSize);
+    size_t lineNumber = 1;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        lines.push_back(std::move(line));
+        if (lines.size() == chunkSize) {
+            onChunk(lines, lineNumber);
+            lineNumber += lines.size();
+            lines.clear();
+        }
+    }
+    if (!lines.empty()) onChunk(lines, lineNumber);
+    return true;
+}
+
+#endif // KTP_IMPORT_H
@@ -0,0 +1,134 @@
+// Utilitas JSON minimal bersama: escape string dan parser objek datar
+//
+// Dipakai oleh server HTTP (body request) dan antrian remote (baris status dari sync_command.js).
+#ifndef KTP_JSON_H
+#define KTP_JSON_H
+
+#include <cctype>
+#include <cstdio>
+#include <map>
+#include <string>
+
+inline std::string jsonEscape(const std::string& value) {
+    std::string out;
+    out.reserve(value.size() + 2);
+    for (unsigned char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buffer[8];
+                    snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    return out;
+}
+
+// Parser untuk objek JSON datar (nilai string, angka, boolean). Cukup untuk body request API.
+// Mengembalikan false bila body bukan objek JSON yang valid. Karakter kontrol mentah (< 0x20) selalu
+// ditolak, seperti spesifikasi JSON. Escape yang menghasilkan karakter kontrol (\n, \t, \u0000, ...)
+// juga ditolak kecuali allowControlEscapes: nilai body request berakhir di file snapshot yang
+// dipisahkan tab/newline, sedangkan pesan status dari sync_command.js boleh berisi newline.
+inline bool parseFlatJson(const std::string& text, std::map<std::string, std::string>& out,
+                          bool allowControlEscapes = false) {
+    size_t i = 0;
+    auto skipSpace = [&]() {
+        while (i < text.size() && isspace(static_cast<unsigned char>(text[i]))) ++i;
+    };
+    auto parseString = [&](std::string& result) -> bool {
+        if (i >= text.size() || text[i] != '"') return false;
+        ++i;
+        while (i < text.size() && text[i] != '"') {
+            char c = text[i++];
+            if (static_cast<unsigned char>(c) < 0x20) return false;
+            if (c != '\\') {
+                result += c;
+                continue;
+            }
+            if (i >= text.size()) return false;
+            char e = text[i++];
+            if (!allowControlEscapes && (e == 'n' || e == 't' || e == 'r' || e == 'b' || e == 'f')) return false;
+            switch (e) {
+                case 'n': result += '\n'; break;
+                case 't': result += '\t'; break;
+                case 'r': result += '\r'; break;
+                case 'b': result += '\b'; break;
+                case 'f': result += '\f'; break;
+                case 'u': {
+                    // Tepat empat digit hex; stoul akan menerima "+1", spasi, atau melempar exception
+                    if (i + 4 > text.size()) return false;
+                    unsigned code = 0;
+                    for (size_t end = i + 4; i < end; ++i) {
+                        char h = text[i];
+                        unsigned digit;
+                        if (h >= '0' && h <= '9') digit = static_cast<unsigned>(h - '0');
+                        else if (h >= 'a' && h <= 'f') digit = static_cast<unsigned>(h - 'a' + 10);
+                        else if (h >= 'A' && h <= 'F') digit = static_cast<unsigned>(h - 'A' + 10);
+                        else return false;
+                        code = code * 16 + digit;
+                    }
+                    if (code < 0x20 && !allowControlEscapes) return false;
+                    // Encode sebagai UTF-8 (surrogate pair tidak didukung)
+                    if (code < 0x80) {
+                        result += static_cast<char>(code);
+                    } else if (code < 0x800) {
+                        result += static_cast<char>(0xC0 | (code >> 6));
+                        result += static_cast<char>(0x80 | (code & 0x3F));
+                    } else {
+                        result += static_cast<char>(0xE0 | (code >> 12));
+                        result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        result += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default: result += e;
+            }
+        }
+        if (i >= text.size()) return false;
+        ++i;
+        return true;
+    };
+
+    skipSpace();
+    if (i >= text.size() || text[i] != '{') return false;
+    ++i;
+    skipSpace();
+    if (i < text.size() && text[i] == '}') return true;
+    while (i < text.size()) {
+        skipSpace();
+        std::string key, value;
+        if (!parseString(key)) return false;
+        skipSpace();
+        if (i >= text.size() || text[i] != ':') return false;
+        ++i;
+        skipSpace();
+        if (i < text.size() && text[i] == '"') {
+            if (!parseString(value)) return false;
+        } else {
+            size_t start = i;
+            while (i < text.size() && text[i] != ',' && text[i] != '}') ++i;
+            value = text.substr(start, i - start);
+            while (!value.empty() && isspace(static_cast<unsigned char>(value.back()))) value.pop_back();
+            if (value.empty() || value[0] == '{' || value[0] == '[') return false;
+        }
+        out[key] = value;
+        skipSpace();
+        if (i < text.size() && text[i] == ',') {
+            ++i;
+            continue;
+        }
+        if (i < text.size() && text[i] == '}') return true;
+        return false;
+    }
+    return false;
+}
+
+#endif // KTP_JSON_H
@@ -0,0 +1,96 @@
+// Perkiraan pemakaian memori struktur data KtpSystem
+//
+// Angka dihitung dari ukuran objek dan kapasitas container, bukan diukur dari allocator, dan
+// mengikuti tata letak libstdc++/glibc: setiap alokasi heap diberi header 8 byte dan dibulatkan
+// ke kelipatan 16 (minimal 32), string <= 15 karakter disimpan inline (SSO), dan node
+// unordered_map menyimpan pointer next dan hash kunci.
+#ifndef KTP_MEMORY_H
+#define KTP_MEMORY_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ktpmem {
+
+// Byte yang benar-benar terpakai allocator untuk satu permintaan malloc(requested)
+inline size_t allocationBytes(size_t requested) {
+    if (requested == 0) return 0;
+    size_t chunk = (requested + 8 + 15) & ~size_t(15);
+    return chunk < 32 ? 32 : chunk;
+}
+
+// Byte heap di luar objek string itu sendiri (0 bila isinya muat di buffer SSO)
+inline size_t stringHeapBytes(const std::string& value) {
+    const char* data = value.data();
+    const char* object = reinterpret_cast<const char*>(&value);
+    if (data >= object && data < object + sizeof(value)) return 0;
+    return allocationBytes(value.capacity() + 1);
+}
+
+template <typename T>
+size_t vectorBytes(const std::vector<T>& values) {
+    return allocationBytes(values.capacity() * sizeof(T));
+}
+
+// Array bucket + satu alokasi per node. Isi heap dari key/value dihitung terpisah oleh pemanggil.
+template <typename Map>
+size_t hashTableBytes(const Map& map) {
+    using Value = typename Map::value_type;
+    return allocationBytes(map.bucket_count() * sizeof(void*)) +
+           map.size() * allocationBytes(sizeof(Value) + sizeof(void*) + sizeof(size_t));
+}
+
+// Node std::list: nilai + pointer prev/next
+template <typename T>
+constexpr size_t listNodeBytes() {
+    return sizeof(T) + 2 * sizeof(void*);
+}
+
+} // namespace ktpmem
+
+struct MemoryUsage {
+    std::string structure;
+    size_t items = 0;
+    size_t bytes = 0;
+};
+
+struct MemoryReport {
+    std::vector<MemoryUsage> structures;
+    size_t applications = 0;
+    size_t spillFileBytes = 0; // Data dingin di disk (mode kapasitas); tidak termasuk total()
+
+    size_t total() const {
+        size_t sum = 0;
+        for (const auto& usage : structures) sum += usage.bytes;
+        return sum;
+    }
+
+    size_t bytesPerApplication() const {
+        return applications == 0 ? 0 : total() / applications;
+    }
+
+    // Perkiraan jumlah aplikasi yang muat per GiB dengan komposisi data saat ini
+    size_t applicationsPerGiB() const {
+        size_t perApp = bytesPerApplication();
+        return perApp == 0 ? 0 : (size_t(1) << 30) / perApp;
+    }
+
+    void writeText(std::ostream& out) const {
+        out << "\n--- Pemakaian Memori (perkiraan) ---\n";
+        for (const auto& usage : structures) {
+            out << "  " << usage.structure << ": " << usage.bytes << " byte (" << usage.items << " item)\n";
+        }
+        out << "  Total: " << total() << " byte untuk " << applications << " aplikasi";
+        if (applications > 0) {
+            out << " (" << bytesPerApplication() << " byte/aplikasi, ~" << applicationsPerGiB() << " aplikasi/GiB)";
+        }
+        out << "\n";
+        if (spillFileBytes > 0) {
+            out << "  File spill di disk: " << spillFileBytes << " byte\n";
+        }
+    }
+};
+
+#endif // KTP_MEMORY_H
@@ -0,0 +1,275 @@
+// Instrumentasi ringan untuk KtpSystem: counter dan histogram latensi lock-free
+//
+// - Setiap operasi publik dan setiap fase I/O (parse, index, persist, sync, snapshot_lock) dicatat
+//   dengan KTP_TIMED(KtpMetric::...).
+// - Saat runtime, pencatatan hanya aktif bila metrics().enable() dipanggil (mis. karena
+//   env KTP_METRICS_FILE di-set); bila tidak, biayanya satu load atomic + satu cabang.
+// - Definisikan KTP_NO_METRICS saat kompilasi untuk menghapus instrumentasi sepenuhnya.
+#ifndef KTP_METRICS_H
+#define KTP_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+enum class KtpMetric {
+    // Operasi publik
+    Submit,
+    Verify,
+    Edit,
+    Undo,
+    Display,
+    Sort,
+    Refresh,
+    Import,
+    // Fase I/O
+    Parse,
+    Index,
+    Persist,
+    Sync,
+    SnapshotLock, // Lama stateMutex ditahan oleh writeSnapshot
+    Count
+};
+
+inline const char* metricName(KtpMetric metric) {
+    switch (metric) {
+        case KtpMetric::Submit: return "submit";
+        case KtpMetric::Verify: return "verify";
+        case KtpMetric::Edit: return "edit";
+        case KtpMetric::Undo: return "undo";
+        case KtpMetric::Display: return "display";
+        case KtpMetric::Sort: return "sort";
+        case KtpMetric::Refresh: return "refresh";
+        case KtpMetric::Import: return "import";
+        case KtpMetric::Parse: return "parse";
+        case KtpMetric::Index: return "index";
+        case KtpMetric::Persist: return "persist";
+        case KtpMetric::Sync: return "sync";
+        case KtpMetric::SnapshotLock: return "snapshot_lock";
+        default: return "unknown";
+    }
+}
+
+inline bool isPhaseMetric(KtpMetric metric) {
+    return metric >= KtpMetric::Parse;
+}
+
+// Histogram dengan bucket eksponensial (batas atas 2^i mikrodetik)
+class LatencyHistogram {
+public:
+    static constexpr int BUCKETS = 28; // 1us .. ~134s, bucket terakhir = +Inf
+
+    void record(uint64_t nanos) {
+        uint64_t micros = nanos / 1000;
+        int bucket = 0;
+        while (bucket < BUCKETS - 1 && micros > (uint64_t(1) << bucket)) {
+            ++bucket;
+        }
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sumNanos.fetch_add(nanos, std::memory_order_relaxed);
+    }
+
+    uint64_t bucketCount(int bucket) const { return buckets[bucket].load(std::memory_order_relaxed); }
+    uint64_t totalCount() const { return count.load(std::memory_order_relaxed); }
+    uint64_t totalNanos() const { return sumNanos.load(std::memory_order_relaxed); }
+
+    static double upperBoundSeconds(int bucket) {
+        return static_cast<double>(uint64_t(1) << bucket) / 1e6;
+    }
+
+    // Perkiraan persentil dari bucket (batas atas bucket yang memuat persentil tsb)
+    double percentileSeconds(double p) const {
+        uint64_t total = totalCount();
+        if (total == 0) return 0.0;
+        uint64_t target = static_cast<uint64_t>(p * static_cast<double>(total));
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += bucketCount(i);
+            if (seen > target) return upperBoundSeconds(i);
+        }
+        return upperBoundSeconds(BUCKETS - 1);
+    }
+
+private:
+    std::atomic<uint64_t> buckets[BUCKETS] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sumNanos{0};
+};
+
+class KtpMetrics {
+public:
+    ~KtpMetrics() { stopExporter(); }
+
+    bool enabled() const { return isEnabled.load(std::memory_order_relaxed); }
+    void enable() { isEnabled.store(true, std::memory_order_relaxed); }
+
+    void record(KtpMetric metric, uint64_t nanos) {
+        histograms[static_cast<int>(metric)].record(nanos);
+    }
+
+    // Ringkasan yang mudah dibaca untuk menu CLI
+    // Tabel disusun di ostringstream lokal agar flag/presisi stream pemanggil (mis. cout) tidak berubah
+    void dumpStats(std::ostream& stream) const {
+        stream << "\n--- Statistik Kinerja ---\n";
+        if (!enabled()) {
+            stream << "(Instrumentasi nonaktif. Set KTP_METRICS_FILE atau KTP_METRICS=1 untuk mengaktifkan.)\n";
+            return;
+        }
+        std::ostringstream out;
+        out << std::left << std::setw(14) << "metrik" << std::right << std::setw(10) << "jumlah"
+            << std::setw(14) << "rata2 (ms)" << std::setw(14) << "p50 (ms)" << std::setw(14) << "p99 (ms)" << "\n";
+        for (int i = 0; i < static_cast<int>(KtpMetric::Count); ++i) {
+            const LatencyHistogram& h = histograms[i];
+            uint64_t n = h.totalCount();
+            double avgMs = n ? static_cast<double>(h.totalNanos()) / static_cast<double>(n) / 1e6 : 0.0;
+            out << std::left << std::setw(14) << metricName(static_cast<KtpMetric>(i)) << std::right
+                << std::setw(10) << n << std::fixed << std::setprecision(3)
+                << std::setw(14) << avgMs
+                << std::setw(14) << h.percentileSeconds(0.50) * 1e3
+                << std::setw(14) << h.percentileSeconds(0.99) * 1e3 << "\n";
+            out.unsetf(std::ios::fixed);
+        }
+        stream << out.str();
+    }
+
+    // Format teks Prometheus (exposition format 0.0.4)
+    void writePrometheus(std::ostream& out) const {
+        out << "# HELP ktp_operation_duration_seconds Latensi operasi publik KtpSystem.\n"
+            << "# TYPE ktp_operation_duration_seconds histogram\n";
+        writeFamily(out, "ktp_operation_duration_seconds", "op", false);
+        out << "# HELP ktp_io_phase_duration_seconds Latensi fase I/O (parse, index, persist, sync, snapshot_lock).\n"
+            << "# TYPE ktp_io_phase_duration_seconds histogram\n";
+        writeFamily(out, "ktp_io_phase_duration_seconds", "phase", true);
+    }
+
+    // Menulis file Prometheus secara berkala dari thread latar belakang.
+    // File ditulis ke <path>.tmp lalu di-rename agar scraper tidak membaca file setengah jadi.
+    void startExporter(const std::string& path, int intervalSeconds) {
+        stopExporter();
+        enable();
+        exportPath = path;
+        stopRequested = false;
+        exporter = std::thread([this, intervalSeconds]() {
+            std::unique_lock<std::mutex> lock(exporterMutex);
+            while (!stopRequested) {
+                exporterCv.wait_for(lock, std::chrono::seconds(intervalSeconds), [this]() { return stopRequested; });
+                writePrometheusFile();
+            }
+        });
+    }
+
+    void stopExporter() {
+        if (!exporter.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(exporterMutex);
+            stopRequested = true;
+        }
+        exporterCv.notify_all();
+        exporter.join();
+    }
+
+    // Mengaktifkan instrumentasi dari environment:
+    //   KTP_METRICS=1                 -> hanya pencatatan (lihat menu statistik)
+    //   KTP_METRICS_FILE=path         -> juga tulis file Prometheus secara berkala
+    //   KTP_METRICS_INTERVAL=detik    -> interval penulisan (default 15)
+    void configureFromEnv() {
+        const char* file = std::getenv("KTP_METRICS_FILE");
+        const char* flag = std::getenv("KTP_METRICS");
+        if (file != nullptr && *file != '\0') {
+            const char* interval = std::getenv("KTP_METRICS_INTERVAL");
+            int seconds = interval != nullptr ? std::atoi(interval) : 0;
+            startExporter(file, seconds > 0 ? seconds : 15);
+        } else if (flag != nullptr && std::string(flag) == "1") {
+            enable();
+        }
+    }
+
+private:
+    LatencyHistogram histograms[static_cast<int>(KtpMetric::Count)];
+    std::atomic<bool> isEnabled{false};
+
+    std::string exportPath;
+    std::thread exporter;
+    std::mutex exporterMutex;
+    std::condition_variable exporterCv;
+    bool stopRequested = false;
+
+    void writeFamily(std::ostream& out, const char* family, const char* label, bool phases) const {
+        for (int i = 0; i < static_cast<int>(KtpMetric::Count); ++i) {
+            KtpMetric metric = static_cast<KtpMetric>(i);
+            if (isPhaseMetric(metric) != phases) continue;
+            const LatencyHistogram& h = histograms[i];
+            uint64_t cumulative = 0;
+            for (int b = 0; b < LatencyHistogram::BUCKETS - 1; ++b) {
+                cumulative += h.bucketCount(b);
+                out << family << "_bucket{" << label << "=\"" << metricName(metric) << "\",le=\""
+                    << LatencyHistogram::upperBoundSeconds(b) << "\"} " << cumulative << "\n";
+            }
+            out << family << "_bucket{" << label << "=\"" << metricName(metric) << "\",le=\"+Inf\"} "
+                << h.totalCount() << "\n";
+            out << family << "_sum{" << label << "=\"" << metricName(metric) << "\"} "
+                << static_cast<double>(h.totalNanos()) / 1e9 << "\n";
+            out << family << "_count{" << label << "=\"" << metricName(metric) << "\"} " << h.totalCount() << "\n";
+        }
+    }
+
+    void writePrometheusFile() const {
+        std::string tmpPath = exportPath + ".tmp";
+        {
+            std::ofstream file(tmpPath);
+            if (!file.is_open()) return;
+            writePrometheus(file);
+        }
+        std::remove(exportPath.c_str()); // rename() di Windows gagal bila tujuan sudah ada
+        std::rename(tmpPath.c_str(), exportPath.c_str());
+    }
+};
+
+inline KtpMetrics& metrics() {
+    static KtpMetrics instance;
+    return instance;
+}
+
+// Mengukur durasi scope dan mencatatnya ke histogram bila instrumentasi aktif
+class ScopedTimer {
+public:
+    explicit ScopedTimer(KtpMetric m) : metric(m), active(metrics().enabled()) {
+        if (active) start = std::chrono::steady_clock::now();
+    }
+    ~ScopedTimer() {
+        if (active) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            metrics().record(metric, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    KtpMetric metric;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define KTP_METRICS_CONCAT_(a, b) a##b
+#define KTP_METRICS_CONCAT(a, b) KTP_METRICS_CONCAT_(a, b)
+
+#ifdef KTP_NO_METRICS
+#define KTP_TIMED(metric) ((void)0)
+#else
+#define KTP_TIMED(metric) ScopedTimer KTP_METRICS_CONCAT(ktpTimer_, __LINE__)(metric)
+#endif
+
+#endif // KTP_METRICS_H
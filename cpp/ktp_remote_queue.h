@@ -0,0 +1,334 @@
+// Antrian perintah remote asinkron untuk ktp_system_bst (klien Supabase)
+//
+// - enqueue() langsung kembali dengan shared_future; thread pekerja mengumpulkan perintah selama
+//   jendela singkat lalu mengirimnya sebagai satu batch ke sync_command.js, yang menggabungkan
+//   submit/verify/edit berurutan menjadi insert/update/upsert massal.
+// - Setiap batch memakai file perintah/respons unik (pid + nomor urut), sehingga beberapa CLI bisa
+//   berjalan bersamaan tanpa saling menimpa ktp_command.txt/ktp_response.txt.
+// - Format file batch:            Format file respons (satu objek JSON per baris per perintah):
+//     batch                         {"id":"<correlationId>","status":"ok","message":"..."}
+//     no-resync                     status "error": gagal permanen, "retry": gagal sementara,
+//     session <token>               "blocked": tidak dijalankan karena perintah sebelumnya untuk
+//     <correlationId>|<cmd>|<data>  ID yang sama belum selesai
+//   Status dibaca dari field JSON, bukan dari awalan teks pesan. Perintah tanpa baris respons yang
+//   valid (mis. skrip crash) dianggap gagal sementara; status lain yang tidak dikenal dianggap gagal.
+// - session + correlationId unik per perintah; server mencatat hasil akhir per kunci tersebut dan
+//   mengembalikan hasil yang sama bila perintah dikirim ulang, sehingga retry setelah respons
+//   hilang tidak menjalankan submit/edit/undo dua kali.
+// - Bila log perintah server tidak bisa dibaca/ditulis, file respons memuat baris
+//   {"batch":"degraded","message":"..."}. Pada batch seperti itu hanya perintah di
+//   retrySafeCommands yang diulang; perintah lain yang gagal sementara atau tanpa respons langsung
+//   dilaporkan gagal, dan perintah yang sudah punya hasil tidak ditahan untuk dikirim ulang.
+// - Gagal sementara (juga "blocked" yang tidak disebabkan perintah lain di batch yang sama) diulang
+//   maksimal maxAttempts kali dengan backoff eksponensial + jitter.
+//   Urutan per ID (bagian pertama data) dijaga: perintah yang diulang kembali ke depan antrian, dan
+//   perintah berikutnya untuk ID yang sama ikut ditahan sampai perintah sebelumnya selesai.
+#ifndef KTP_REMOTE_QUEUE_H
+#define KTP_REMOTE_QUEUE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ktp_json.h"
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+struct RemoteResult {
+    uint64_t correlationId = 0;
+    bool ok = false;
+    std::string message;
+    int attempts = 0;
+};
+
+using RemoteCallback = std::function<void(const RemoteResult&)>;
+
+// Menjalankan skrip backend untuk satu file batch; mengembalikan exit code proses
+using BatchRunner = std::function<int(const std::string& commandFile, const std::string& responseFile)>;
+
+struct RemoteQueueOptions {
+    size_t maxBatch = 100;
+    int batchWindowMs = 20; // Menunggu perintah lain sebelum mengirim batch
+    int maxAttempts = 4;
+    int baseBackoffMs = 200; // Backoff ke-n: base * 2^(n-1), plus jitter hingga 50%
+    std::unordered_set<std::string> retrySafeCommands = {"verify"}; // Aman dijalankan dua kali
+    // Dipanggil dari thread pekerja (tanpa lock) dengan pesan server saat batch berjalan degraded
+    std::function<void(const std::string&)> onDegraded;
+};
+
+class RemoteCommandQueue {
+public:
+    RemoteCommandQueue(const std::filesystem::path& workDir, BatchRunner batchRunner,
+                       RemoteQueueOptions queueOptions = RemoteQueueOptions())
+        : dir(workDir), runner(std::move(batchRunner)), options(queueOptions), jitter(std::random_device{}()) {
+#ifdef _WIN32
+        processId = static_cast<long>(_getpid());
+#else
+        processId = static_cast<long>(getpid());
+#endif
+        auto started = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::system_clock::now().time_since_epoch()).count();
+        session = std::to_string(processId) + "-" + std::to_string(started) + "-" + std::to_string(jitter());
+        worker = std::thread([this]() { run(); });
+    }
+
+    // Menunggu semua perintah (termasuk percobaan ulang) selesai sebelum berhenti
+    ~RemoteCommandQueue() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        worker.join();
+    }
+
+    RemoteCommandQueue(const RemoteCommandQueue&) = delete;
+    RemoteCommandQueue& operator=(const RemoteCommandQueue&) = delete;
+
+    // coalesceKey: bila perintah terakhir yang masih menunggu untuk ID yang sama memiliki kunci yang
+    // sama (mis. dua verifikasi berturut-turut), perintah digabung dan berbagi future yang sama.
+    // Perintah lain untuk ID tersebut di antaranya (mis. edit) mencegah penggabungan.
+    std::shared_future<RemoteResult> enqueue(const std::string& command, const std::string& data,
+                                             RemoteCallback callback = nullptr, const std::string& coalesceKey = "") {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string targetId = data.substr(0, data.find('|'));
+        if (!coalesceKey.empty()) {
+            for (auto it = queue.rbegin(); it != queue.rend(); ++it) {
+                if (it->targetId != targetId) continue;
+                if (it->coalesceKey != coalesceKey) break;
+                if (callback) it->callbacks.push_back(std::move(callback));
+                return it->future;
+            }
+        }
+        Pending pending;
+        pending.correlationId = nextCorrelationId++;
+        pending.command = command;
+        pending.data = data;
+        pending.targetId = std::move(targetId);
+        pending.coalesceKey = coalesceKey;
+        pending.promise = std::make_shared<std::promise<RemoteResult>>();
+        pending.future = pending.promise->get_future().share();
+        if (callback) pending.callbacks.push_back(std::move(callback));
+        std::shared_future<RemoteResult> future = pending.future;
+        queue.push_back(std::move(pending));
+        cv.notify_all();
+        return future;
+    }
+
+    // Menunggu sampai antrian kosong dan tidak ada batch yang sedang dikirim
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idleCv.wait(lock, [this]() { return queue.empty() && !inFlight; });
+    }
+
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.size() + (inFlight ? inFlightCount : 0);
+    }
+
+private:
+    struct Pending {
+        uint64_t correlationId = 0;
+        std::string command;
+        std::string data;
+        std::string targetId; // Bagian pertama data; urutan perintah dijaga per targetId
+        std::string coalesceKey;
+        int attempts = 0;
+        std::shared_ptr<std::promise<RemoteResult>> promise;
+        std::shared_future<RemoteResult> future;
+        std::vector<RemoteCallback> callbacks;
+    };
+
+    std::filesystem::path dir;
+    BatchRunner runner;
+    RemoteQueueOptions options;
+    std::minstd_rand jitter;
+    long processId = 0;
+    std::string session; // Bersama correlationId menjadi kunci idempotensi di server
+    uint64_t batchSequence = 0;
+    uint64_t nextCorrelationId = 1;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::condition_variable idleCv;
+    std::deque<Pending> queue;
+    std::chrono::steady_clock::time_point retryAfter;
+    bool inFlight = false;
+    size_t inFlightCount = 0;
+    bool stopping = false;
+    std::thread worker;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) break; // stopping dan tidak ada sisa
+
+            // Jendela pengumpulan; saat berhenti batch langsung dikirim
+            if (!stopping && queue.size() < options.maxBatch) {
+                cv.wait_for(lock, std::chrono::milliseconds(options.batchWindowMs),
+                            [this]() { return stopping || queue.size() >= options.maxBatch; });
+            }
+            // Backoff setelah gagal sementara tetap dihormati, juga saat berhenti
+            while (std::chrono::steady_clock::now() < retryAfter) {
+                cv.wait_until(lock, retryAfter);
+            }
+
+            std::vector<Pending> batch;
+            while (!queue.empty() && batch.size() < options.maxBatch) {
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+            inFlight = true;
+            inFlightCount = batch.size();
+            lock.unlock();
+
+            BatchResponse batchResponse = sendBatch(batch);
+            const auto& responses = batchResponse.results;
+            bool degraded = !batchResponse.degraded.empty();
+
+            std::vector<std::pair<Pending, RemoteResult>> completed;
+            std::vector<Pending> retries;
+            std::unordered_set<std::string> held;    // ID yang perintahnya diulang pada batch ini
+            std::unordered_set<std::string> retried; // ID dengan perintah "retry" pada batch ini (termasuk yang habis)
+            bool backoffNeeded = false;
+            for (auto& pending : batch) {
+                auto response = responses.find(pending.correlationId);
+                std::string status = response == responses.end() ? "retry" : response->second.first;
+                if (status != "ok" && status != "retry" && status != "blocked") status = "error";
+                // Tanpa log perintah, mengirim ulang perintah yang mungkin sudah dijalankan akan menjalankannya
+                // lagi: hasil yang ada dipakai apa adanya dan perintah yang tidak aman tidak diulang
+                bool unsafeRetry = status == "retry" && options.retrySafeCommands.count(pending.command) == 0;
+                bool final = degraded && (status == "ok" || status == "error" || unsafeRetry);
+                // Hasil perintah setelah perintah yang diulang untuk ID yang sama belum dipakai; server
+                // mengembalikan hasil tercatat saat dikirim ulang, sehingga tidak dijalankan dua kali.
+                // "blocked" karena perintah sebelumnya di batch ini gagal sementara tidak dihitung.
+                if (!final && (held.count(pending.targetId) > 0 || (status == "blocked" && retried.count(pending.targetId) > 0))) {
+                    held.insert(pending.targetId);
+                    retries.push_back(std::move(pending));
+                    continue;
+                }
+                if (status == "retry") retried.insert(pending.targetId);
+                // Selain itu setiap putaran dihitung, termasuk "blocked" tanpa sebab di batch ini, supaya
+                // server yang terus menjawab "blocked" tidak membuat node dijalankan tanpa henti
+                pending.attempts++;
+                std::string message = response == responses.end() ? "Tidak ada respons dari server" : response->second.second;
+                if (!final && (status == "retry" || status == "blocked") && pending.attempts < options.maxAttempts) {
+                    held.insert(pending.targetId);
+                    retries.push_back(std::move(pending));
+                    backoffNeeded = true;
+                    continue;
+                }
+                if (degraded && unsafeRetry) {
+                    message = "tidak diulang karena log perintah server tidak tersedia (" + batchResponse.degraded +
+                              "), perintah mungkin sudah atau belum dijalankan: " + message;
+                }
+                RemoteResult result{pending.correlationId, status == "ok", message, pending.attempts};
+                completed.emplace_back(std::move(pending), std::move(result));
+            }
+
+            if (degraded && options.onDegraded) options.onDegraded(batchResponse.degraded);
+
+            lock.lock();
+            if (!retries.empty()) {
+                // Kembali ke depan antrian dengan urutan semula; semua perintah yang menunggu lebih baru,
+                // sehingga urutan perintah per ID terjaga
+                int attempt = 1;
+                for (auto it = retries.rbegin(); it != retries.rend(); ++it) {
+                    attempt = std::max(attempt, it->attempts);
+                    queue.push_front(std::move(*it));
+                }
+                if (backoffNeeded) {
+                    int backoff = options.baseBackoffMs << std::min(attempt - 1, 10);
+                    backoff += static_cast<int>(jitter() % static_cast<unsigned>(backoff / 2 + 1));
+                    retryAfter = std::chrono::steady_clock::now() + std::chrono::milliseconds(backoff);
+                }
+            }
+            lock.unlock();
+
+            // Callback dan promise dijalankan tanpa memegang lock, sehingga callback boleh enqueue lagi
+            for (auto& entry : completed) {
+                for (auto& callback : entry.first.callbacks) callback(entry.second);
+                entry.first.promise->set_value(entry.second);
+            }
+
+            lock.lock();
+            inFlight = false;
+            inFlightCount = 0;
+            idleCv.notify_all();
+        }
+        idleCv.notify_all();
+    }
+
+    struct BatchResponse {
+        std::unordered_map<uint64_t, std::pair<std::string, std::string>> results; // correlationId -> (status, pesan)
+        std::string degraded; // Pesan baris "batch":"degraded"; kosong bila log perintah berfungsi
+    };
+
+    // Menulis file batch, menjalankan runner, dan membaca respons per correlation ID
+    BatchResponse sendBatch(const std::vector<Pending>& batch) {
+        uint64_t sequence = ++batchSequence;
+        std::string suffix = std::to_string(processId) + "_" + std::to_string(sequence) + ".txt";
+        std::filesystem::path commandPath = dir / ("ktp_command_" + suffix);
+        std::filesystem::path responsePath = dir / ("ktp_response_" + suffix);
+
+        {
+            std::ofstream commandFile(commandPath);
+            commandFile << "batch\nno-resync\nsession " << session << '\n';
+            for (const auto& pending : batch) {
+                commandFile << pending.correlationId << '|' << pending.command << '|' << pending.data << '\n';
+            }
+        }
+
+        runner(commandPath.string(), responsePath.string());
+
+        BatchResponse responses;
+        std::ifstream responseFile(responsePath);
+        std::string line;
+        while (std::getline(responseFile, line)) {
+            std::map<std::string, std::string> fields;
+            if (!parseFlatJson(line, fields, true)) continue; // Baris log atau baris terpotong
+            auto batchStatus = fields.find("batch");
+            if (batchStatus != fields.end()) {
+                if (batchStatus->second == "degraded") {
+                    responses.degraded = fields["message"].empty() ? "tanpa keterangan" : fields["message"];
+                }
+                continue;
+            }
+            auto id = fields.find("id");
+            auto status = fields.find("status");
+            if (id == fields.end() || status == fields.end()) continue;
+            try {
+                responses.results[std::stoull(id->second)] = {status->second, fields["message"]};
+            } catch (const std::exception&) {
+                continue;
+            }
+        }
+        responseFile.close();
+
+        std::error_code ec;
+        std::filesystem::remove(commandPath, ec);
+        std::filesystem::remove(responsePath, ec);
+        return responses;
+    }
+};
+
+#endif // KTP_REMOTE_QUEUE_H
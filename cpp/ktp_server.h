@@ -0,0 +1,465 @@
+// Server HTTP/1.1 minimal untuk mode server KtpSystem
+//
+// - Event loop satu thread berbasis poll() (WSAPoll di Windows) dengan socket non-blocking.
+//   Handler dipanggil berurutan dari thread ini; KtpSystem sendiri mengunci stateMutex di setiap
+//   operasi publik karena SnapshotWriter membaca state dari thread latar belakang. Handler yang
+//   lambat menahan seluruh event loop, jadi operasi di handler harus sebanding dengan hasilnya.
+// - Koneksi keep-alive dan request pipelined didukung; body dibaca lewat Content-Length.
+// - Batas per koneksi: request berikutnya tidak diproses (dan socket tidak dibaca) selama output
+//   yang belum terkirim >= MAX_OUTPUT_BYTES, sehingga klien yang lambat membaca tidak membuat
+//   buffer tumbuh tanpa batas. Koneksi tanpa kemajuan baca/tulis selama idle timeout (default
+//   IDLE_TIMEOUT_SECONDS) ditutup, dan koneksi di atas MAX_CONNECTIONS langsung ditolak.
+// - Routing dilakukan oleh pemanggil lewat HttpHandler.
+//
+// Di Windows link dengan -lws2_32.
+#ifndef KTP_SERVER_H
+#define KTP_SERVER_H
+
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ktp_json.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+#define KTP_INVALID_SOCKET INVALID_SOCKET
+#define ktpPoll WSAPoll
+#define ktpCloseSocket closesocket
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int socket_t;
+#define KTP_INVALID_SOCKET (-1)
+#define ktpPoll poll
+#define ktpCloseSocket close
+#endif
+
+struct HttpRequest {
+    std::string method;
+    std::string path;  // Tanpa query string, sudah di-decode
+    std::map<std::string, std::string> query;
+    std::map<std::string, std::string> headers; // Nama header dalam huruf kecil
+    std::string body;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string contentType = "application/json";
+    std::string body;
+};
+
+typedef std::function<HttpResponse(const HttpRequest&)> HttpHandler;
+
+// --- Utilitas JSON ---
+
+inline std::string jsonError(const std::string& message) {
+    return "{\"error\":\"" + jsonEscape(message) + "\"}";
+}
+
+inline std::string urlDecode(const std::string& value) {
+    std::string out;
+    out.reserve(value.size());
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] == '%' && i + 2 < value.size() && isxdigit(static_cast<unsigned char>(value[i + 1])) &&
+            isxdigit(static_cast<unsigned char>(value[i + 2]))) {
+            out += static_cast<char>(std::stoi(value.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else if (value[i] == '+') {
+            out += ' ';
+        } else {
+            out += value[i];
+        }
+    }
+    return out;
+}
+
+// --- Server ---
+
+class HttpServer {
+private:
+    struct Connection {
+        std::string in;
+        std::string out;
+        bool closeAfterWrite = false;
+        bool peerClosed = false; // Peer sudah menutup sisi tulisnya (half-close)
+        std::chrono::steady_clock::time_point lastActive = std::chrono::steady_clock::now();
+    };
+
+    static constexpr size_t MAX_HEADER_BYTES = 64 * 1024;
+    static constexpr size_t MAX_BODY_BYTES = 4 * 1024 * 1024;
+    static constexpr size_t MAX_INPUT_BYTES = MAX_HEADER_BYTES + MAX_BODY_BYTES + 64 * 1024; // Muat satu request terbesar
+    static constexpr size_t MAX_OUTPUT_BYTES = 8 * 1024 * 1024;
+    static constexpr size_t MAX_CONNECTIONS = 1024;
+    static constexpr int IDLE_TIMEOUT_SECONDS = 60;
+
+    std::string host;
+    int port;
+    HttpHandler handler;
+    std::chrono::seconds idleTimeout{IDLE_TIMEOUT_SECONDS};
+    socket_t listener = KTP_INVALID_SOCKET;
+    std::unordered_map<socket_t, Connection> connections;
+
+    static volatile std::sig_atomic_t& stopFlag() {
+        static volatile std::sig_atomic_t flag = 0;
+        return flag;
+    }
+
+    static void onSignal(int) { stopFlag() = 1; }
+
+    static bool setNonBlocking(socket_t sock) {
+#ifdef _WIN32
+        u_long mode = 1;
+        return ioctlsocket(sock, FIONBIO, &mode) == 0;
+#else
+        int flags = fcntl(sock, F_GETFL, 0);
+        return flags >= 0 && fcntl(sock, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+    }
+
+    static bool wouldBlock() {
+#ifdef _WIN32
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+    }
+
+    static const char* statusText(int status) {
+        switch (status) {
+            case 200: return "OK";
+            case 201: return "Created";
+            case 204: return "No Content";
+            case 400: return "Bad Request";
+            case 404: return "Not Found";
+            case 405: return "Method Not Allowed";
+            case 409: return "Conflict";
+            case 413: return "Payload Too Large";
+            default: return "Internal Server Error";
+        }
+    }
+
+    static void appendResponse(Connection& conn, const HttpResponse& response, bool keepAlive) {
+        std::ostringstream head;
+        head << "HTTP/1.1 " << response.status << " " << statusText(response.status) << "\r\n"
+             << "Content-Type: " << response.contentType << "\r\n"
+             << "Content-Length: " << response.body.size() << "\r\n"
+             << "Connection: " << (keepAlive ? "keep-alive" : "close") << "\r\n\r\n";
+        conn.out += head.str();
+        conn.out += response.body;
+    }
+
+    static void parseQuery(const std::string& text, std::map<std::string, std::string>& query) {
+        size_t start = 0;
+        while (start <= text.size()) {
+            size_t end = text.find('&', start);
+            if (end == std::string::npos) end = text.size();
+            std::string pair = text.substr(start, end - start);
+            if (!pair.empty()) {
+                size_t eq = pair.find('=');
+                if (eq == std::string::npos) {
+                    query[urlDecode(pair)] = "";
+                } else {
+                    query[urlDecode(pair.substr(0, eq))] = urlDecode(pair.substr(eq + 1));
+                }
+            }
+            start = end + 1;
+        }
+    }
+
+    // Memproses semua request lengkap di buffer input. Mengembalikan false bila koneksi harus ditutup segera.
+    // Berhenti lebih awal bila output yang antre sudah mencapai MAX_OUTPUT_BYTES; sisa input
+    // diproses setelah output terkirim. Input yang terpakai dibuang sekali di akhir supaya request
+    // pipelined dalam jumlah besar tidak menggeser buffer berulang kali.
+    bool processInput(Connection& conn) {
+        size_t consumed = 0;
+        bool keep = processRequests(conn, consumed);
+        conn.in.erase(0, consumed);
+        return keep;
+    }
+
+    bool processRequests(Connection& conn, size_t& consumed) {
+        while (!conn.closeAfterWrite && conn.out.size() < MAX_OUTPUT_BYTES) {
+            size_t headerEnd = conn.in.find("\r\n\r\n", consumed);
+            if (headerEnd == std::string::npos) {
+                if (conn.in.size() - consumed > MAX_HEADER_BYTES) {
+                    appendResponse(conn, {413, "application/json", jsonError("Header terlalu besar")}, false);
+                    conn.closeAfterWrite = true;
+                }
+                return true;
+            }
+
+            HttpRequest request;
+            std::istringstream head(conn.in.substr(consumed, headerEnd - consumed));
+            std::string requestLine, version, target;
+            std::getline(head, requestLine);
+            std::istringstream requestLineStream(requestLine);
+            requestLineStream >> request.method >> target >> version;
+            if (request.method.empty() || target.empty()) {
+                appendResponse(conn, {400, "application/json", jsonError("Request tidak valid")}, false);
+                conn.closeAfterWrite = true;
+                return true;
+            }
+
+            std::string line;
+            while (std::getline(head, line)) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                size_t colon = line.find(':');
+                if (colon == std::string::npos) continue;
+                std::string name = line.substr(0, colon);
+                for (auto& c : name) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+                size_t valueStart = line.find_first_not_of(' ', colon + 1);
+                request.headers[name] = valueStart == std::string::npos ? "" : line.substr(valueStart);
+            }
+
+            size_t contentLength = 0;
+            auto lengthIt = request.headers.find("content-length");
+            if (lengthIt != request.headers.end()) {
+                try {
+                    contentLength = static_cast<size_t>(std::stoull(lengthIt->second));
+                } catch (const std::exception&) {
+                    contentLength = MAX_BODY_BYTES + 1;
+                }
+            }
+            if (contentLength > MAX_BODY_BYTES) {
+                appendResponse(conn, {413, "application/json", jsonError("Body terlalu besar")}, false);
+                conn.closeAfterWrite = true;
+                return true;
+            }
+            size_t bodyStart = headerEnd + 4;
+            if (conn.in.size() < bodyStart + contentLength) {
+                return true; // Tunggu sisa body
+            }
+            request.body = conn.in.substr(bodyStart, contentLength);
+            consumed = bodyStart + contentLength;
+
+            size_t queryStart = target.find('?');
+            request.path = urlDecode(target.substr(0, queryStart));
+            if (queryStart != std::string::npos) {
+                parseQuery(target.substr(queryStart + 1), request.query);
+            }
+
+            auto connectionIt = request.headers.find("connection");
+            std::string connectionHeader = connectionIt == request.headers.end() ? "" : connectionIt->second;
+            bool keepAlive = version == "HTTP/1.0" ? connectionHeader == "keep-alive" : connectionHeader != "close";
+
+            HttpResponse response;
+            try {
+                response = handler(request);
+            } catch (const std::exception& e) {
+                response = {500, "application/json", jsonError(e.what())};
+            }
+            appendResponse(conn, response, keepAlive);
+            if (!keepAlive) conn.closeAfterWrite = true;
+        }
+        return true;
+    }
+
+    // Mengirim sebanyak mungkin data keluar tanpa blocking. Mengembalikan false bila koneksi harus ditutup.
+    bool flushOutput(socket_t sock, Connection& conn) {
+        while (!conn.out.empty()) {
+#ifdef _WIN32
+            int sent = send(sock, conn.out.data(), static_cast<int>(conn.out.size()), 0);
+#elif defined(MSG_NOSIGNAL)
+            ssize_t sent = send(sock, conn.out.data(), conn.out.size(), MSG_NOSIGNAL);
+#else
+            ssize_t sent = send(sock, conn.out.data(), conn.out.size(), 0);
+#endif
+            if (sent < 0) {
+                if (wouldBlock()) return true;
+                conn.out.clear(); // Koneksi rusak: buang sisa output dan tutup
+                conn.closeAfterWrite = true;
+                return false;
+            }
+            conn.out.erase(0, static_cast<size_t>(sent));
+            conn.lastActive = std::chrono::steady_clock::now();
+        }
+        return !conn.closeAfterWrite;
+    }
+
+    // Memproses request yang lengkap dan mengirim respons sejauh socket mengizinkan, bergantian
+    // selama output tidak tertahan. Mengembalikan false bila koneksi harus ditutup.
+    bool serve(socket_t sock, Connection& conn) {
+        while (true) {
+            size_t pending = conn.in.size();
+            processInput(conn);
+            bool open = flushOutput(sock, conn);
+            if (conn.out.empty() && !open) return false;
+            if (!conn.out.empty() || conn.in.size() == pending) break; // Socket penuh atau tidak ada request lengkap
+        }
+        // Peer tidak akan mengirim request lagi: tutup setelah semua respons terkirim
+        return !(conn.peerClosed && conn.out.empty());
+    }
+
+    void closeIdleConnections() {
+        auto now = std::chrono::steady_clock::now();
+        std::vector<socket_t> idle;
+        for (const auto& entry : connections) {
+            if (now - entry.second.lastActive > idleTimeout) idle.push_back(entry.first);
+        }
+        for (socket_t sock : idle) closeConnection(sock);
+    }
+
+    void closeConnection(socket_t sock) {
+        ktpCloseSocket(sock);
+        connections.erase(sock);
+    }
+
+    void acceptConnections() {
+        while (true) {
+            socket_t client = accept(listener, nullptr, nullptr);
+            if (client == KTP_INVALID_SOCKET) return;
+            if (connections.size() >= MAX_CONNECTIONS) {
+                ktpCloseSocket(client);
+                continue;
+            }
+            setNonBlocking(client);
+            int noDelay = 1;
+            setsockopt(client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+            connections[client] = Connection();
+        }
+    }
+
+    // Membaca data dari koneksi sampai MAX_INPUT_BYTES; sisanya dibiarkan di socket sampai request
+    // yang sudah ada diproses. Mengembalikan false bila peer menutup koneksi atau terjadi error.
+    bool readInput(socket_t sock, Connection& conn) {
+        char buffer[16384];
+        while (conn.in.size() < MAX_INPUT_BYTES) {
+#ifdef _WIN32
+            int received = recv(sock, buffer, sizeof(buffer), 0);
+#else
+            ssize_t received = recv(sock, buffer, sizeof(buffer), 0);
+#endif
+            if (received > 0) {
+                conn.in.append(buffer, static_cast<size_t>(received));
+                conn.lastActive = std::chrono::steady_clock::now();
+                continue;
+            }
+            if (received == 0) return false;
+            return wouldBlock();
+        }
+        return true;
+    }
+
+public:
+    HttpServer(const std::string& bindHost, int bindPort, HttpHandler requestHandler)
+        : host(bindHost), port(bindPort), handler(std::move(requestHandler)) {}
+
+    ~HttpServer() {
+        for (auto& entry : connections) ktpCloseSocket(entry.first);
+        if (listener != KTP_INVALID_SOCKET) ktpCloseSocket(listener);
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+
+    // Koneksi tanpa kemajuan baca/tulis selama ini ditutup (KTP_SERVER_IDLE_SECONDS)
+    void setIdleTimeout(std::chrono::seconds timeout) {
+        idleTimeout = timeout;
+    }
+
+    // Menjalankan event loop sampai SIGINT/SIGTERM. Mengembalikan false bila gagal bind/listen.
+    bool run() {
+#ifdef _WIN32
+        WSADATA wsaData;
+        if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+            std::cerr << "WSAStartup gagal." << std::endl;
+            return false;
+        }
+#else
+        std::signal(SIGPIPE, SIG_IGN);
+#endif
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (listener == KTP_INVALID_SOCKET) {
+            std::cerr << "Tidak bisa membuat socket." << std::endl;
+            return false;
+        }
+        int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+            std::cerr << "Alamat host tidak valid: " << host << std::endl;
+            return false;
+        }
+        if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listener, 128) != 0) {
+            std::cerr << "Tidak bisa listen di " << host << ":" << port << std::endl;
+            return false;
+        }
+        setNonBlocking(listener);
+        std::cout << "Server KTP berjalan di http://" << host << ":" << port << " (Ctrl+C untuk berhenti)" << std::endl;
+
+        std::vector<pollfd> fds;
+        while (!stopFlag()) {
+            fds.clear();
+            fds.push_back({listener, POLLIN, 0});
+            for (const auto& entry : connections) {
+                // Buffer penuh (output belum diambil klien atau input belum diproses): berhenti membaca
+                bool readable = !entry.second.peerClosed && entry.second.out.size() < MAX_OUTPUT_BYTES &&
+                                entry.second.in.size() < MAX_INPUT_BYTES;
+                short events = readable ? POLLIN : 0;
+                if (!entry.second.out.empty()) events |= POLLOUT;
+                fds.push_back({entry.first, events, 0});
+            }
+
+            int ready = ktpPoll(fds.data(), static_cast<decltype(fds.size())>(fds.size()), 1000);
+            if (ready <= 0) { // Timeout atau EINTR: cek stopFlag lalu ulangi
+                closeIdleConnections();
+                continue;
+            }
+
+            if (fds[0].revents & POLLIN) {
+                acceptConnections();
+            }
+            for (size_t i = 1; i < fds.size(); ++i) {
+                if (fds[i].revents == 0) continue;
+                socket_t sock = fds[i].fd;
+                auto it = connections.find(sock);
+                if (it == connections.end()) continue;
+                Connection& conn = it->second;
+
+                bool keep = true;
+                if (fds[i].revents & POLLIN) {
+                    if (!readInput(sock, conn)) conn.peerClosed = true;
+                } else if (fds[i].revents & (POLLERR | POLLNVAL)) {
+                    keep = false;
+                } else if ((fds[i].revents & POLLHUP) && conn.out.empty()) {
+                    keep = false;
+                }
+                // Respons tetap dikirim walaupun peer sudah menutup sisi tulisnya; koneksi baru ditutup
+                // setelah semua request terjawab dan buffer output kosong (sisanya saat POLLOUT berikutnya)
+                if (keep) keep = serve(sock, conn);
+                if (!keep) closeConnection(sock);
+            }
+            closeIdleConnections();
+        }
+        std::cout << "Server KTP berhenti." << std::endl;
+        return true;
+    }
+};
+
+#endif // KTP_SERVER_H
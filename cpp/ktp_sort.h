@@ -0,0 +1,216 @@
+// Kernel pengurutan multi-kunci yang dispesialisasi saat kompilasi
+//
+// sortByKeys<ByRegion, ByTime>(items, project) mengurutkan items berdasarkan tuple kunci
+// (region, submissionTime). Untuk setiap item, prefiks kunci dinormalisasi menjadi kata 64-bit
+// (string: byte awal big-endian, angka: sign bit dibalik) sehingga sebagian besar perbandingan
+// adalah perbandingan integer; string penuh hanya dibandingkan bila prefiksnya sama.
+// Bila semua kunci numerik (mis. hanya ByTime), dipakai radix sort LSD tanpa perbandingan sama sekali.
+// Urutan stabil: item dengan kunci sama tetap dalam urutan input.
+#ifndef KTP_SORT_H
+#define KTP_SORT_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ktpsort {
+
+// Mengemas byte ke-[offset, offset+8) sebuah string menjadi integer big-endian (0 untuk byte sesudah akhir)
+inline uint64_t stringWord(const std::string& value, size_t offset) {
+    uint64_t word = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        size_t pos = offset + i;
+        unsigned char c = pos < value.size() ? static_cast<unsigned char>(value[pos]) : 0;
+        word = (word << 8) | c;
+    }
+    return word;
+}
+
+// Kunci string: WORDS kata prefiks, perbandingan penuh bila prefiks sama
+template <int Words>
+struct StringKey {
+    static constexpr int WORDS = Words;
+    static constexpr bool NUMERIC = false;
+
+    static void encode(const std::string& value, uint64_t* out) {
+        for (int i = 0; i < Words; ++i) out[i] = stringWord(value, static_cast<size_t>(i) * 8);
+    }
+
+    // Prefiks sama dan kedua string muat seluruhnya di prefiks berarti keduanya sama. Panjang harus
+    // sama karena prefiks diisi 0: "ab" dan "ab\0" punya prefiks yang identik.
+    static bool prefixIsExact(const std::string& a, const std::string& b) {
+        return a.size() <= Words * 8 && b.size() <= Words * 8 && a.size() == b.size();
+    }
+};
+
+// Kunci numerik bertanda: satu kata, prefiks selalu tepat
+struct NumericKey {
+    static constexpr int WORDS = 1;
+    static constexpr bool NUMERIC = true;
+
+    static void encode(int64_t value, uint64_t* out) {
+        out[0] = static_cast<uint64_t>(value) ^ (uint64_t(1) << 63);
+    }
+};
+
+struct ByName : StringKey<2> {  // Banyak nama berbagi 8 byte pertama ("Muhammad ...")
+    template <typename R> static const std::string& get(const R& r) { return r.name; }
+};
+
+struct ByRegion : StringKey<1> {
+    template <typename R> static const std::string& get(const R& r) { return r.region; }
+};
+
+struct ByStatus : StringKey<1> {
+    template <typename R> static const std::string& get(const R& r) { return r.status; }
+};
+
+struct ByTime : NumericKey {
+    template <typename R> static int64_t get(const R& r) { return static_cast<int64_t>(r.submissionTime); }
+};
+
+template <typename... Keys>
+struct KeySet {
+    static constexpr int WORDS = (Keys::WORDS + ...);
+    static constexpr bool ALL_NUMERIC = (Keys::NUMERIC && ...);
+};
+
+template <int Words>
+struct Entry {
+    std::array<uint64_t, Words> prefix;
+    uint32_t index; // Posisi di input; juga penentu urutan terakhir agar hasil stabil
+};
+
+// Menulis prefiks setiap kunci secara berurutan ke out
+template <typename Record>
+inline void encodeKeys(const Record&, uint64_t*) {}
+
+template <typename Record, typename Key, typename... Rest>
+inline void encodeKeys(const Record& record, uint64_t* out) {
+    Key::encode(Key::get(record), out);
+    encodeKeys<Record, Rest...>(record, out + Key::WORDS);
+}
+
+// Membandingkan kunci satu per satu: prefiks integer dulu, string penuh hanya bila perlu
+template <typename Record>
+inline int compareKeys(const Record&, const Record&, const uint64_t*, const uint64_t*) {
+    return 0;
+}
+
+template <typename Record, typename Key, typename... Rest>
+inline int compareKeys(const Record& a, const Record& b, const uint64_t* pa, const uint64_t* pb) {
+    for (int i = 0; i < Key::WORDS; ++i) {
+        if (pa[i] != pb[i]) return pa[i] < pb[i] ? -1 : 1;
+    }
+    if constexpr (!Key::NUMERIC) {
+        const std::string& ka = Key::get(a);
+        const std::string& kb = Key::get(b);
+        if (!Key::prefixIsExact(ka, kb)) {
+            // Byte yang pasti sama hanya sampai ujung string terpendek di dalam prefiks; mulai
+            // dari posisi yang sama di kedua string supaya byte NUL di akhir tetap dibandingkan
+            size_t offset = std::min({static_cast<size_t>(Key::WORDS) * 8, ka.size(), kb.size()});
+            int c = ka.compare(offset, std::string::npos, kb, offset, std::string::npos);
+            if (c != 0) return c < 0 ? -1 : 1;
+        }
+    }
+    return compareKeys<Record, Rest...>(a, b, pa + Key::WORDS, pb + Key::WORDS);
+}
+
+// Radix sort LSD stabil atas kata-kata prefiks, digit 16-bit. Digit yang sama untuk semua
+// entri (mis. bit atas timestamp) dilewati.
+template <int Words>
+void radixSort(std::vector<Entry<Words>>& entries) {
+    std::vector<Entry<Words>> buffer(entries.size());
+    std::vector<size_t> counts(1 << 16);
+    for (int word = Words - 1; word >= 0; --word) {
+        for (int shift = 0; shift < 64; shift += 16) {
+            std::fill(counts.begin(), counts.end(), 0);
+            for (const auto& e : entries) counts[(e.prefix[word] >> shift) & 0xFFFF]++;
+            if (counts[(entries[0].prefix[word] >> shift) & 0xFFFF] == entries.size()) continue;
+            size_t sum = 0;
+            for (auto& c : counts) {
+                size_t current = c;
+                c = sum;
+                sum += current;
+            }
+            for (const auto& e : entries) buffer[counts[(e.prefix[word] >> shift) & 0xFFFF]++] = e;
+            entries.swap(buffer);
+        }
+    }
+}
+
+} // namespace ktpsort
+
+namespace ktpsort {
+
+template <typename... Keys, typename Item, typename Project>
+auto encodeEntries(const std::vector<Item>& items, Project project) {
+    using Record = std::decay_t<decltype(project(items[0]))>;
+    std::vector<Entry<KeySet<Keys...>::WORDS>> entries(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        encodeKeys<Record, Keys...>(project(items[i]), entries[i].prefix.data());
+        entries[i].index = static_cast<uint32_t>(i);
+    }
+    return entries;
+}
+
+// Urutan total atas entri: kunci dulu, lalu posisi input (menjamin stabil)
+template <typename... Keys, typename Item, typename Project>
+auto entryLess(const std::vector<Item>& items, Project project) {
+    using Record = std::decay_t<decltype(project(items[0]))>;
+    constexpr int WORDS = KeySet<Keys...>::WORDS;
+    return [&items, project](const Entry<WORDS>& a, const Entry<WORDS>& b) {
+        int c = compareKeys<Record, Keys...>(project(items[a.index]), project(items[b.index]),
+                                             a.prefix.data(), b.prefix.data());
+        return c != 0 ? c < 0 : a.index < b.index;
+    };
+}
+
+template <int Words, typename Item>
+void gatherEntries(std::vector<Item>& items, const std::vector<Entry<Words>>& entries) {
+    std::vector<Item> sorted;
+    sorted.reserve(entries.size());
+    for (const auto& e : entries) sorted.push_back(std::move(items[e.index]));
+    items.swap(sorted);
+}
+
+} // namespace ktpsort
+
+// Mengurutkan items (mis. iterator, pointer, atau record) berdasarkan Keys...;
+// project(item) harus mengembalikan const Record&.
+template <typename... Keys, typename Item, typename Project>
+void sortByKeys(std::vector<Item>& items, Project project) {
+    using namespace ktpsort;
+    if (items.size() < 2) return;
+
+    auto entries = encodeEntries<Keys...>(items, project);
+    if constexpr (KeySet<Keys...>::ALL_NUMERIC) {
+        radixSort(entries);
+    } else {
+        std::sort(entries.begin(), entries.end(), entryLess<Keys...>(items, project));
+    }
+    gatherEntries(items, entries);
+}
+
+// Menyisakan hanya `count` item pertama menurut urutan sortByKeys, sudah terurut.
+// O(n + count log count): dipakai untuk satu halaman hasil tanpa mengurutkan semua item.
+template <typename... Keys, typename Item, typename Project>
+void selectFirstByKeys(std::vector<Item>& items, size_t count, Project project) {
+    using namespace ktpsort;
+    if (count >= items.size()) {
+        sortByKeys<Keys...>(items, project);
+        return;
+    }
+    auto entries = encodeEntries<Keys...>(items, project);
+    auto less = entryLess<Keys...>(items, project);
+    std::nth_element(entries.begin(), entries.begin() + count, entries.end(), less);
+    entries.resize(count);
+    std::sort(entries.begin(), entries.end(), less);
+    gatherEntries(items, entries);
+}
+
+#endif // KTP_SORT_H
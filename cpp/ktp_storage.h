@@ -0,0 +1,496 @@
+// Persistensi crash-consistent untuk KtpSystem lokal
+//
+// Protokol snapshot (lihat KtpSnapshotStore::commit):
+//   1. Tulis setiap file ke <nama>.tmp, fsync.
+//   2. Tulis manifest (generasi + ukuran + checksum tiap file) ke ktp_manifest.txt.tmp, fsync.
+//   3. Rename manifest.tmp -> manifest. Ini titik commit: snapshot baru dianggap ada.
+//   4. fsync direktori, sehingga rename manifest (dan entri file .tmp) tersimpan sebelum file
+//      data mana pun diganti. Tanpa ini, setelah crash file data generasi baru bisa muncul
+//      bersama manifest lama.
+//   5. Rename setiap <nama>.tmp -> <nama>, lalu fsync direktori lagi. Rename yang gagal membuat
+//      commit() mengembalikan false; file .tmp-nya tetap cocok dengan manifest dan diselesaikan
+//      oleh recover() berikutnya.
+// Saat startup, KtpSnapshotStore::recover() menyelesaikan rename yang tertunda (roll-forward)
+// atau membuang file .tmp dari snapshot yang belum ter-commit, sehingga file aplikasi dan
+// revisi selalu berasal dari generasi yang sama.
+#ifndef KTP_STORAGE_H
+#define KTP_STORAGE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// FNV-1a 64-bit, cukup untuk mendeteksi file yang terpotong/rusak
+class Fnv1a64 {
+public:
+    void update(const char* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    uint64_t value() const { return hash; }
+
+private:
+    uint64_t hash = 0xcbf29ce484222325ULL;
+};
+
+inline bool fsyncFile(FILE* file) {
+    if (fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// fsync direktori agar rename ikut tersimpan (tidak diperlukan/didukung di Windows)
+inline bool fsyncDirectory(const std::filesystem::path& dir) {
+#ifndef _WIN32
+    int fd = open(dir.string().c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+#else
+    (void)dir;
+    return true;
+#endif
+}
+
+// Penulis file dengan buffer besar yang menghitung ukuran dan checksum sambil menulis
+class DurableFileWriter {
+public:
+    explicit DurableFileWriter(const std::filesystem::path& filePath) : path(filePath) {
+        file = fopen(path.string().c_str(), "wb");
+        buffer.reserve(BUFFER_SIZE);
+    }
+
+    ~DurableFileWriter() {
+        if (file != nullptr) fclose(file);
+    }
+
+    DurableFileWriter(const DurableFileWriter&) = delete;
+    DurableFileWriter& operator=(const DurableFileWriter&) = delete;
+
+    bool isOpen() const { return file != nullptr; }
+
+    void append(const std::string& data) {
+        buffer += data;
+        if (buffer.size() >= BUFFER_SIZE) flushBuffer();
+    }
+
+    // Flush + fsync + close. Mengembalikan false bila ada error I/O.
+    bool finish() {
+        flushBuffer();
+        bool ok = !failed && file != nullptr && fsyncFile(file);
+        if (file != nullptr && fclose(file) != 0) ok = false;
+        file = nullptr;
+        return ok;
+    }
+
+    // Menandai isi file tidak valid: finish() mengembalikan false sehingga commit dibatalkan
+    void fail() { failed = true; }
+
+    uint64_t size() const { return written; }
+    uint64_t checksum() const { return hash.value(); }
+
+private:
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+    std::filesystem::path path;
+    FILE* file = nullptr;
+    std::string buffer;
+    Fnv1a64 hash;
+    uint64_t written = 0;
+    bool failed = false;
+
+    void flushBuffer() {
+        if (buffer.empty() || file == nullptr) return;
+        hash.update(buffer.data(), buffer.size());
+        if (fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) failed = true;
+        written += buffer.size();
+        buffer.clear();
+    }
+};
+
+struct ManifestEntry {
+    uint64_t size = 0;
+    uint64_t checksum = 0;
+};
+
+class KtpSnapshotStore {
+public:
+    explicit KtpSnapshotStore(const std::filesystem::path& directory)
+        : dir(directory), manifestPath(directory / "ktp_manifest.txt") {}
+
+    uint64_t generation() const { return currentGeneration; }
+
+    static std::filesystem::path tmpPath(const std::filesystem::path& path) {
+        return std::filesystem::path(path.string() + ".tmp");
+    }
+
+    // Memulihkan direktori data ke snapshot ter-commit terakhir. Dipanggil sebelum memuat file.
+    void recover(const std::vector<std::string>& fileNames) {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+
+        // Manifest.tmp yang tersisa berarti crash sebelum commit: snapshot itu dibuang
+        if (fs::exists(tmpPath(manifestPath))) {
+            fs::remove(tmpPath(manifestPath), ec);
+        }
+
+        std::map<std::string, ManifestEntry> entries;
+        if (!readManifest(entries)) {
+            // Belum ada manifest (data lama): file dipakai apa adanya
+            for (const auto& name : fileNames) fs::remove(tmpPath(dir / name), ec);
+            return;
+        }
+
+        for (const auto& name : fileNames) {
+            fs::path finalPath = dir / name;
+            auto it = entries.find(name);
+            if (it == entries.end()) {
+                fs::remove(tmpPath(finalPath), ec);
+                continue;
+            }
+            if (matches(finalPath, it->second)) {
+                fs::remove(tmpPath(finalPath), ec);
+            } else if (matches(tmpPath(finalPath), it->second)) {
+                // Crash setelah commit tetapi sebelum rename: selesaikan rename
+                fs::rename(tmpPath(finalPath), finalPath, ec);
+                std::cout << "Memulihkan '" << name << "' dari snapshot generasi " << currentGeneration << "." << std::endl;
+            } else {
+                std::cerr << "Peringatan: '" << name << "' tidak cocok dengan manifest generasi "
+                          << currentGeneration << "; file dimuat apa adanya." << std::endl;
+            }
+        }
+        fsyncDirectory(dir);
+    }
+
+    // Menulis satu snapshot. writers berisi (nama file, fungsi yang menulis isi file).
+    bool commit(const std::vector<std::pair<std::string, std::function<void(DurableFileWriter&)>>>& writers) {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        fs::create_directories(dir, ec);
+
+        uint64_t nextGeneration = currentGeneration + 1;
+        std::ostringstream manifest;
+        manifest << "generation " << nextGeneration << "\n";
+        for (const auto& entry : writers) {
+            DurableFileWriter writer(tmpPath(dir / entry.first));
+            if (!writer.isOpen()) {
+                std::cerr << "Tidak bisa membuka file untuk menulis: " << tmpPath(dir / entry.first).string() << std::endl;
+                return false;
+            }
+            entry.second(writer);
+            if (!writer.finish()) {
+                std::cerr << "Gagal menulis snapshot: " << entry.first << std::endl;
+                return false;
+            }
+            manifest << "file " << entry.first << " " << writer.size() << " " << std::hex << writer.checksum()
+                     << std::dec << "\n";
+        }
+
+        DurableFileWriter manifestWriter(tmpPath(manifestPath));
+        manifestWriter.append(manifest.str());
+        if (!manifestWriter.finish()) {
+            std::cerr << "Gagal menulis manifest snapshot." << std::endl;
+            return false;
+        }
+
+        fs::rename(tmpPath(manifestPath), manifestPath, ec); // Titik commit
+        if (ec) {
+            std::cerr << "Gagal meng-commit snapshot: " << ec.message() << std::endl;
+            return false;
+        }
+        currentGeneration = nextGeneration;
+        if (!fsyncDirectory(dir)) {
+            // Manifest baru mungkin belum tahan crash; file data lama dibiarkan agar tetap cocok
+            // dengan manifest mana pun yang bertahan
+            std::cerr << "Gagal fsync direktori snapshot; file data belum diganti." << std::endl;
+            return false;
+        }
+
+        bool ok = true;
+        for (const auto& entry : writers) {
+            fs::rename(tmpPath(dir / entry.first), dir / entry.first, ec);
+            if (ec) {
+                std::cerr << "Gagal mengganti '" << entry.first << "': " << ec.message() << std::endl;
+                ok = false;
+            }
+        }
+        if (!fsyncDirectory(dir)) ok = false;
+        return ok;
+    }
+
+private:
+    std::filesystem::path dir;
+    std::filesystem::path manifestPath;
+    uint64_t currentGeneration = 0;
+
+    bool readManifest(std::map<std::string, ManifestEntry>& entries) {
+        std::ifstream file(manifestPath);
+        if (!file.is_open()) return false;
+        std::string line;
+        while (std::getline(file, line)) {
+            std::istringstream ss(line);
+            std::string kind;
+            ss >> kind;
+            if (kind == "generation") {
+                ss >> currentGeneration;
+            } else if (kind == "file") {
+                std::string name;
+                ManifestEntry entry;
+                ss >> name >> entry.size >> std::hex >> entry.checksum;
+                entries[name] = entry;
+            }
+        }
+        return true;
+    }
+
+    static bool matches(const std::filesystem::path& path, const ManifestEntry& expected) {
+        std::error_code ec;
+        if (!std::filesystem::exists(path, ec) || std::filesystem::file_size(path, ec) != expected.size) {
+            return false;
+        }
+        std::ifstream file(path, std::ios::binary);
+        Fnv1a64 hash;
+        std::vector<char> buffer(1 << 20);
+        while (file) {
+            file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            hash.update(buffer.data(), static_cast<size_t>(file.gcount()));
+        }
+        return hash.value() == expected.checksum;
+    }
+};
+
+// Thread latar belakang yang menjalankan penulisan snapshot. Permintaan yang datang saat
+// penulisan sedang berjalan digabung menjadi satu penulisan berikutnya.
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(std::function<void()> writeSnapshot) : write(std::move(writeSnapshot)) {
+        worker = std::thread([this]() { run(); });
+    }
+
+    ~SnapshotWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        worker.join(); // run() menyelesaikan snapshot yang tertunda sebelum berhenti
+    }
+
+    void schedule() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            dirty = true;
+        }
+        cv.notify_all();
+    }
+
+    // Menunggu sampai semua snapshot yang dijadwalkan selesai ditulis
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idleCv.wait(lock, [this]() { return !dirty && !writing; });
+    }
+
+private:
+    std::function<void()> write;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::condition_variable idleCv;
+    bool dirty = false;
+    bool writing = false;
+    bool stopping = false;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [this]() { return dirty || stopping; });
+            if (!dirty && stopping) break;
+            dirty = false;
+            writing = true;
+            lock.unlock();
+            write();
+            lock.lock();
+            writing = false;
+            idleCv.notify_all();
+        }
+        idleCv.notify_all();
+    }
+};
+
+struct SpillRef {
+    uint64_t offset = 0;
+    uint32_t length = 0;
+};
+
+// Tier spill untuk data dingin (KTP_CAPACITY_MODE): record ditulis append-only ke satu file dan
+// di memori hanya disimpan SpillRef-nya. Durabilitas tetap dari snapshot, jadi isi file hanya
+// berlaku selama proses berjalan:
+// - Nama file diberi pid dan nomor urut (<nama>.<pid>-<n><ext>), sehingga beberapa proses atau
+//   instance tidak saling menimpa. Di POSIX file langsung di-unlink setelah dibuka dan hilang
+//   sendiri saat ditutup atau proses mati; di Windows file dihapus saat close().
+// - Record yang dilepas (release) dihitung sebagai sampah. Pemilik ref memanggil compact() bila
+//   needsCompaction(): record yang masih dipakai disalin ke file baru dan ref-nya diperbarui.
+// Aman dipanggil dari beberapa thread (mis. SnapshotWriter membaca saat thread utama menulis).
+class SpillFile {
+public:
+    // Kompaksi bila sampah minimal sebesar ini dan lebih besar dari data yang masih dipakai,
+    // sehingga biaya salin teramortisasi O(1) per record yang dilepas
+    static constexpr uint64_t MIN_COMPACT_GARBAGE = 1 << 20;
+
+    ~SpillFile() {
+        close();
+    }
+
+    bool open(const std::filesystem::path& basePath) {
+        close();
+        static std::atomic<unsigned> sequence{0};
+        std::lock_guard<std::mutex> lock(mutex);
+#ifdef _WIN32
+        long processId = static_cast<long>(_getpid());
+#else
+        long processId = static_cast<long>(getpid());
+#endif
+        primaryPath = basePath.parent_path() / (basePath.stem().string() + "." + std::to_string(processId) + "-" +
+                                                std::to_string(sequence++) + basePath.extension().string());
+        path = primaryPath;
+        return openAt(path, file);
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!file.is_open()) return;
+        file.close();
+        std::error_code ec;
+        std::filesystem::remove(path, ec); // Di POSIX sudah di-unlink saat dibuka
+        size = 0;
+        garbage = 0;
+    }
+
+    SpillRef append(const std::string& record) {
+        std::lock_guard<std::mutex> lock(mutex);
+        SpillRef ref{size, static_cast<uint32_t>(record.size())};
+        file.clear();
+        file.seekp(static_cast<std::streamoff>(size));
+        file.write(record.data(), static_cast<std::streamsize>(record.size()));
+        size += record.size();
+        return ref;
+    }
+
+    // "" bila record tidak bisa dibaca
+    std::string read(const SpillRef& ref) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string record(ref.length, '\0');
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(ref.offset));
+        file.read(&record[0], static_cast<std::streamsize>(ref.length));
+        if (!file) return std::string();
+        return record;
+    }
+
+    void release(const SpillRef& ref) {
+        std::lock_guard<std::mutex> lock(mutex);
+        garbage += ref.length;
+    }
+
+    bool needsCompaction() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return garbage >= MIN_COMPACT_GARBAGE && garbage * 2 > size;
+    }
+
+    // Menyalin record yang ditunjuk live ke file baru (berurutan) dan memperbarui ref-nya. Ref lain
+    // yang masih dipegang pemanggil menjadi tidak valid. Bila gagal, file dan ref lama tidak berubah.
+    bool compact(const std::vector<SpillRef*>& live) {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Bergantian antara dua nama, karena di Windows file yang masih terbuka tidak bisa di-rename
+        std::filesystem::path compactPath = primaryPath;
+        if (path == primaryPath) compactPath += ".compact";
+        std::fstream compacted;
+        if (!openAt(compactPath, compacted)) return false;
+
+        std::vector<SpillRef> moved;
+        moved.reserve(live.size());
+        uint64_t offset = 0;
+        std::string record;
+        for (const SpillRef* ref : live) {
+            record.resize(ref->length);
+            file.clear();
+            file.seekg(static_cast<std::streamoff>(ref->offset));
+            file.read(&record[0], static_cast<std::streamsize>(ref->length));
+            compacted.write(record.data(), static_cast<std::streamsize>(record.size()));
+            moved.push_back({offset, ref->length});
+            offset += ref->length;
+        }
+        compacted.flush();
+        if (!file || !compacted) {
+            compacted.close();
+            std::error_code ec;
+            std::filesystem::remove(compactPath, ec);
+            return false;
+        }
+
+        for (size_t i = 0; i < live.size(); ++i) *live[i] = moved[i];
+        file.close();
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        path = compactPath;
+        file = std::move(compacted);
+        size = offset;
+        garbage = 0;
+        return true;
+    }
+
+    uint64_t fileBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return size;
+    }
+
+    uint64_t garbageBytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return garbage;
+    }
+
+private:
+    std::filesystem::path primaryPath;
+    std::filesystem::path path; // primaryPath atau primaryPath + ".compact"
+    mutable std::fstream file;
+    mutable std::mutex mutex;
+    uint64_t size = 0;
+    uint64_t garbage = 0;
+
+    static bool openAt(const std::filesystem::path& target, std::fstream& stream) {
+        stream.open(target, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!stream.is_open()) return false;
+#ifndef _WIN32
+        std::error_code ec;
+        std::filesystem::remove(target, ec);
+#endif
+        return true;
+    }
+};
+
+#endif // KTP_STORAGE_H
@@ -7,6 +7,16 @@
 #include <algorithm>
 #include <filesystem>
 #include <limits>
+#include <map>
+#include <unordered_map>
+#include <cstdlib>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "ktp_metrics.h"
+#include "ktp_remote_queue.h"
+#include "ktp_sort.h"
 
 namespace fs = std::filesystem;
 using namespace std;
@@ -41,11 +51,43 @@ class KtpSystem {
 private:
     BstNode* bstRootByName; // Root dari Binary Search Tree berdasarkan nama
     string outputFilePath;
-    string commandFilePath;
     string responseFilePath;
     string projectRoot;
+    string scriptsDir; // Lokasi skrip Node.js backend (bisa diganti ke backend stub lewat KTP_BACKEND_SCRIPTS)
     const char DELIMITER = '|'; // Delimiter yang digunakan oleh skrip Node.js
 
+    // --- Cache read-through ---
+    // Mutasi diterapkan langsung ke BST (optimistis) lalu dikirim ke server lewat antrian remote di
+    // latar belakang; bila server menolak, cache ditandai basi. Data hanya diambil ulang dari server
+    // bila cache kedaluwarsa (TTL), ditandai basi, atau lewat refreshData(). Reload tidak menunggu
+    // antrian: mutasi yang belum dikonfirmasi server diterapkan ulang di atas data yang baru.
+    unordered_map<string, string> nameById; // ID -> nama (kunci BST), untuk menemukan node berdasarkan ID
+    time_t lastSyncTime;                    // Waktu terakhir data diambil dari server
+    fs::file_time_type loadedFileVersion;   // Waktu modifikasi file sync saat terakhir di-parse
+    int cacheTtlSeconds;
+    atomic<bool> cacheStale;                // Bisa ditandai dari thread antrian remote
+
+    // Mutasi optimistis yang belum selesai di server, urut kirim. Dihapus oleh callback antrian
+    // (thread pekerja), jadi dikunci optimisticMutex; cache sendiri hanya disentuh thread menu.
+    struct OptimisticMutation {
+        string command; // submit, verify, edit, atau undo
+        Applicant value; // Nilai aplikasi setelah mutasi (verify hanya memakai id)
+    };
+    mutex optimisticMutex;
+    map<uint64_t, OptimisticMutation> optimisticMutations;
+    uint64_t nextOptimisticId = 1;
+    // Nilai aplikasi sebelum setiap edit di sesi ini, untuk menerapkan undo tanpa mengambil ulang data.
+    // Dikosongkan per ID bila perintah untuk ID tersebut gagal (riwayat server bisa berbeda).
+    unordered_map<string, vector<Applicant>> localRevisions;
+
+    // --- Antrian perintah remote ---
+    // Hasil perintah datang dari thread pekerja; pesannya disimpan dan dicetak oleh thread menu
+    // lewat reportRemoteResults() agar tidak menyela input pengguna.
+    unique_ptr<RemoteCommandQueue> remoteQueue;
+    mutex remoteMessagesMutex;
+    vector<string> remoteMessages;
+    string degradedMessage; // Peringatan log perintah terakhir, agar tidak dicetak ulang setiap batch
+
     // --- Operasi BST ---
     // Menyisipkan Applicant ke BST berdasarkan nama
     BstNode* bstInsert(BstNode* node, const Applicant& app) {
@@ -72,6 +114,22 @@ private:
         }
     }
 
+    // Mencari node berdasarkan nama dan ID (nama yang sama selalu disisipkan ke kanan)
+    BstNode* bstFindById(BstNode* node, const string& name, const string& id) {
+        while (node != nullptr) {
+            if (name < node->data.name) {
+                node = node->left;
+            } else if (name > node->data.name) {
+                node = node->right;
+            } else if (node->data.id == id) {
+                return node;
+            } else {
+                node = node->right;
+            }
+        }
+        return nullptr;
+    }
+
     // Mencari node dengan nilai minimum (digunakan untuk penghapusan)
     BstNode* bstFindMin(BstNode* node) {
         while (node != nullptr && node->left != nullptr) {
@@ -135,35 +193,142 @@ private:
     }
     // --- Akhir Operasi BST ---
 
+    // ID berbasis region + waktu; diberi akhiran bila beberapa aplikasi diajukan pada detik yang sama
     string generateId(const string& region) {
-        return region + "-" + to_string(time(nullptr));
-    }
-
-    void writeCommand(const string& command, const string& data) {
-        ofstream commandFile(commandFilePath);
-        if (commandFile.is_open()) {
-            commandFile << command << endl;
-            commandFile << data << endl;
-            commandFile.close();
-            cout << "Perintah dikirim. Menunggu respons dari server..." << endl;
-            system(("node \"" + projectRoot + "/scripts/sync_command.js\"").c_str());
-            readResponse();
-        } else {
-            cerr << "Tidak dapat menulis ke: " << commandFilePath << endl;
+        string base = region + "-" + to_string(time(nullptr));
+        string id = base;
+        for (int suffix = 2; nameById.count(id) > 0; ++suffix) {
+            id = base + "-" + to_string(suffix);
+        }
+        return id;
+    }
+
+    // Mengirim perintah ke server lewat antrian remote tanpa menunggu. Bila server akhirnya
+    // menolak (atau semua percobaan ulang gagal), cache ditandai basi dan pesan disimpan untuk menu.
+    // optimistic: nilai yang sudah diterapkan ke cache, diterapkan ulang setiap reload sampai perintah selesai.
+    shared_future<RemoteResult> sendCommand(const string& command, const string& data, const string& label,
+                                            const Applicant* optimistic, bool staleOnSuccess = false,
+                                            const string& coalesceKey = "") {
+        uint64_t optimisticId = 0;
+        string id = data.substr(0, data.find(DELIMITER));
+        if (optimistic != nullptr) {
+            lock_guard<mutex> lock(optimisticMutex);
+            optimisticId = nextOptimisticId++;
+            optimisticMutations[optimisticId] = {command, *optimistic};
         }
+        return remoteQueue->enqueue(command, data, [this, label, staleOnSuccess, optimisticId, id](const RemoteResult& result) {
+            {
+                lock_guard<mutex> lock(optimisticMutex);
+                optimisticMutations.erase(optimisticId);
+                if (!result.ok) localRevisions.erase(id);
+            }
+            if (!result.ok || staleOnSuccess) {
+                cacheStale = true;
+            }
+            if (!result.ok) {
+                lock_guard<mutex> lock(remoteMessagesMutex);
+                remoteMessages.push_back(label + " gagal: " + result.message +
+                                         (result.attempts > 1 ? " (" + to_string(result.attempts) + " percobaan)" : ""));
+            }
+        }, coalesceKey);
+    }
+
+    // Menjalankan sync_command.js untuk satu batch; output skrip dibuang agar tidak menyela menu
+    int runCommandBatch(const string& commandFile, const string& responseFile) {
+#ifdef _WIN32
+        const string quiet = " > NUL 2>&1";
+#else
+        const string quiet = " > /dev/null 2>&1";
+#endif
+        KTP_TIMED(KtpMetric::Sync);
+        return system(("node \"" + scriptsDir + "/sync_command.js\" \"" + commandFile + "\" \"" + responseFile + "\"" + quiet).c_str());
     }
 
-    void readResponse() {
+    string readResponse() {
+        string response;
         ifstream responseFile(responseFilePath);
         if (responseFile.is_open()) {
             string line;
             while (getline(responseFile, line)) {
                 cout << line << endl;
+                response += line + "\n";
             }
             responseFile.close();
         } else {
             cerr << "Tidak dapat membaca dari: " << responseFilePath << endl;
         }
+        return response;
+    }
+
+    fs::file_time_type syncFileVersion() {
+        error_code ec;
+        fs::file_time_type version = fs::last_write_time(outputFilePath, ec);
+        return ec ? fs::file_time_type::min() : version;
+    }
+
+    // Memuat ulang bila cache basi/kedaluwarsa, atau mem-parse ulang file sync (tanpa akses jaringan)
+    // bila file tersebut diperbarui oleh proses lain (mis. `npm run sync`). Tidak menunggu antrian
+    // remote; perubahan optimistis yang belum dikonfirmasi diterapkan ulang oleh parseSyncFile().
+    void ensureFresh() {
+        if (cacheStale || difftime(time(nullptr), lastSyncTime) >= cacheTtlSeconds) {
+            loadApplicationsFromFile();
+        } else if (syncFileVersion() != loadedFileVersion) {
+            cout << "File sinkronisasi berubah, memuat ulang cache lokal..." << endl;
+            parseSyncFile(pendingOptimisticMutations());
+        }
+    }
+
+    vector<OptimisticMutation> pendingOptimisticMutations() {
+        lock_guard<mutex> lock(optimisticMutex);
+        vector<OptimisticMutation> pending;
+        pending.reserve(optimisticMutations.size());
+        for (const auto& entry : optimisticMutations) pending.push_back(entry.second);
+        return pending;
+    }
+
+    // Menerapkan satu mutasi di atas cache. Idempoten, karena data dari server mungkin sudah memuatnya.
+    void applyOptimistic(const OptimisticMutation& mutation) {
+        BstNode* node = cacheFind(mutation.value.id);
+        if (mutation.command == "submit") {
+            if (node == nullptr) cacheInsert(mutation.value);
+            return;
+        }
+        if (node == nullptr) return; // Sudah dihapus di server; biarkan data server
+        if (mutation.command == "verify") {
+            node->data.status = "verified"; // Status bukan kunci BST, cukup ubah di tempat
+            return;
+        }
+        Applicant updated = node->data;
+        updated.name = mutation.value.name;
+        updated.address = mutation.value.address;
+        updated.region = mutation.value.region;
+        updated.status = mutation.value.status;
+        cacheReplace(node, updated);
+    }
+
+    void flushRemoteQueue() {
+        if (remoteQueue && remoteQueue->pending() > 0) {
+            cout << "Menunggu " << remoteQueue->pending() << " perintah terkirim ke server..." << endl;
+            remoteQueue->flush();
+        }
+    }
+
+    void cacheInsert(const Applicant& app) {
+        bstRootByName = bstInsert(bstRootByName, app);
+        nameById[app.id] = app.name;
+    }
+
+    // Mengganti data node; nama adalah kunci BST, jadi node dihapus lalu disisipkan ulang
+    void cacheReplace(BstNode* node, const Applicant& updated) {
+        Applicant current = node->data; // bstRemove bisa menimpa atau menghapus node ini
+        bstRootByName = bstRemove(bstRootByName, current.name, current.id);
+        cacheInsert(updated);
+    }
+
+    // Mencari aplikasi di cache berdasarkan ID (nullptr bila tidak ada)
+    BstNode* cacheFind(const string& id) {
+        auto it = nameById.find(id);
+        return it == nameById.end() ? nullptr : bstFindById(bstRootByName, it->second, id);
     }
 
     void ensureDirectoriesExist() {
@@ -186,13 +351,27 @@ private:
         return currentPath.string();
     }
 
+    // Mengambil seluruh data dari server lalu membangun ulang cache. Mutasi yang masih tertunda saat
+    // pengambilan dimulai diterapkan ulang; yang selesai selama pengambilan juga ikut (aman karena
+    // idempoten), dan yang gagal menandai cache basi lagi.
     void loadApplicationsFromFile() {
-        bstClear(bstRootByName);
-        bstRootByName = nullptr;
-
         cout << "Memuat data aplikasi dari database..." << endl;
-        system(("node \"" + projectRoot + "/scripts/sync_data.js\"").c_str());
+        vector<OptimisticMutation> pending = pendingOptimisticMutations();
+        cacheStale = false; // Sebelum pengambilan, agar penolakan selama pengambilan tetap tercatat
+        {
+            KTP_TIMED(KtpMetric::Sync);
+            system(("node \"" + scriptsDir + "/sync_data.js\"").c_str());
+        }
         readResponse();
+        lastSyncTime = time(nullptr);
+        parseSyncFile(pending);
+    }
+
+    void parseSyncFile(const vector<OptimisticMutation>& pending) {
+        bstClear(bstRootByName);
+        bstRootByName = nullptr;
+        nameById.clear();
+        loadedFileVersion = syncFileVersion();
 
         ifstream file(outputFilePath);
         if (!file.is_open()) {
@@ -200,92 +379,203 @@ private:
             return;
         }
 
-        string line;
-        while (getline(file, line)) {
-            if (line.empty()) continue;
-            stringstream ss(line);
-            string token;
-            vector<string> tokens;
-
-            while (getline(ss, token, DELIMITER)) {
-                tokens.push_back(token);
-            }
+        vector<Applicant> loaded;
+        {
+            KTP_TIMED(KtpMetric::Parse);
+            string line;
+            while (getline(file, line)) {
+                if (line.empty()) continue;
+                stringstream ss(line);
+                string token;
+                vector<string> tokens;
+
+                while (getline(ss, token, DELIMITER)) {
+                    tokens.push_back(token);
+                }
 
-            if (tokens.size() == 6) {
-                Applicant app;
-                app.id = tokens[0];
-                app.name = tokens[1];
-                app.address = tokens[2];
-                app.region = tokens[3];
-                try {
-                    app.submissionTime = stoll(tokens[4]);
-                } catch (const std::exception& e) {
-                    cerr << "Format submissionTime tidak valid untuk ID " << app.id << ": " << tokens[4] << " - " << e.what() << endl;
-                    app.submissionTime = time(nullptr); // Fallback ke waktu saat ini
+                if (tokens.size() == 6) {
+                    Applicant app;
+                    app.id = tokens[0];
+                    app.name = tokens[1];
+                    app.address = tokens[2];
+                    app.region = tokens[3];
+                    try {
+                        app.submissionTime = stoll(tokens[4]);
+                    } catch (const std::exception& e) {
+                        cerr << "Format submissionTime tidak valid untuk ID " << app.id << ": " << tokens[4] << " - " << e.what() << endl;
+                        app.submissionTime = time(nullptr); // Fallback ke waktu saat ini
+                    }
+                    app.status = tokens[5];
+                    loaded.push_back(app);
+                } else {
+                    cerr << "Baris tidak valid di file aplikasi: " << line << endl;
                 }
-                app.status = tokens[5];
-                bstRootByName = bstInsert(bstRootByName, app); // Sisipkan ke BST berbasis nama
-            } else {
-                cerr << "Baris tidak valid di file aplikasi: " << line << endl;
             }
         }
         file.close();
+
+        {
+            KTP_TIMED(KtpMetric::Index);
+            for (const auto& app : loaded) {
+                cacheInsert(app); // Sisipkan ke BST berbasis nama
+            }
+            for (const auto& mutation : pending) {
+                applyOptimistic(mutation);
+            }
+        }
         cout << "Data aplikasi berhasil dimuat dan BST dibangun ulang." << endl;
+        if (!pending.empty()) {
+            cout << pending.size() << " perubahan yang belum dikonfirmasi server diterapkan ulang." << endl;
+        }
     }
 
 public:
-    KtpSystem() : bstRootByName(nullptr) {
+    KtpSystem() : bstRootByName(nullptr), lastSyncTime(0), cacheTtlSeconds(60), cacheStale(true) {
         projectRoot = findProjectRoot();
+        scriptsDir = (fs::path(projectRoot) / "scripts").string();
+        if (const char* backend = getenv("KTP_BACKEND_SCRIPTS")) {
+            scriptsDir = backend;
+        }
+        if (const char* ttl = getenv("KTP_CACHE_TTL")) {
+            cacheTtlSeconds = atoi(ttl);
+        }
         outputFilePath = (fs::path(projectRoot) / "data" / "ktp_applications_sync.txt").string();
-        commandFilePath = (fs::path(projectRoot) / "data" / "ktp_command.txt").string();
         responseFilePath = (fs::path(projectRoot) / "data" / "ktp_response.txt").string();
 
         ensureDirectoriesExist();
         ofstream(outputFilePath, ios::app).close();
-        ofstream(commandFilePath, ios::app).close();
         ofstream(responseFilePath, ios::app).close();
 
+        RemoteQueueOptions queueOptions;
+        if (const char* attempts = getenv("KTP_REMOTE_ATTEMPTS")) {
+            queueOptions.maxAttempts = max(1, atoi(attempts));
+        }
+        if (const char* window = getenv("KTP_REMOTE_BATCH_MS")) {
+            queueOptions.batchWindowMs = max(0, atoi(window));
+        }
+        // Output skrip dibuang (runCommandBatch), jadi kondisi degraded dilaporkan lewat menu
+        queueOptions.onDegraded = [this](const string& message) {
+            lock_guard<mutex> lock(remoteMessagesMutex);
+            if (message == degradedMessage) return;
+            degradedMessage = message;
+            remoteMessages.push_back("Peringatan: " + message +
+                                     ". Submit/edit/undo yang gagal sementara tidak diulang otomatis; periksa datanya.");
+        };
+        remoteQueue = make_unique<RemoteCommandQueue>(
+            fs::path(projectRoot) / "data",
+            [this](const string& commandFile, const string& responseFile) { return runCommandBatch(commandFile, responseFile); },
+            queueOptions);
+
         cout << "Inisialisasi Sistem KTP dengan Integrasi Supabase..." << endl;
         loadApplicationsFromFile(); // Memuat data dari Supabase saat startup
         cout << "Sistem KTP Diinisialisasi." << endl;
     }
 
     ~KtpSystem() {
+        flushRemoteQueue();
+        remoteQueue.reset(); // Menghentikan thread pekerja sebelum cache dibongkar
+        reportRemoteResults();
         bstClear(bstRootByName);
     }
 
-    void submitApplication(const string& name, const string& address, const string& region) {
+    // Mencetak hasil perintah remote yang gagal sejak pemanggilan sebelumnya
+    void reportRemoteResults() {
+        vector<string> messages;
+        {
+            lock_guard<mutex> lock(remoteMessagesMutex);
+            messages.swap(remoteMessages);
+        }
+        // Perintah yang digabung (mis. verifikasi ganda) melaporkan pesan yang sama berulang kali
+        messages.erase(unique(messages.begin(), messages.end()), messages.end());
+        for (const auto& message : messages) {
+            cout << "[Server] " << message << endl;
+        }
+    }
+
+    size_t pendingRemoteCommands() const {
+        return remoteQueue->pending();
+    }
+
+    // Mutasi tidak menunggu server: cache diperbarui langsung dan perintah dikirim di latar
+    // belakang. Future yang dikembalikan bisa ditunggu bila pemanggil butuh konfirmasi server.
+    shared_future<RemoteResult> submitApplication(const string& name, const string& address, const string& region) {
+        KTP_TIMED(KtpMetric::Submit);
         string id = generateId(region);
         time_t now = time(nullptr);
         stringstream ss;
         ss << id << DELIMITER << name << DELIMITER << address << DELIMITER << region << DELIMITER << now << DELIMITER << "pending";
-        writeCommand("submit", ss.str());
-        loadApplicationsFromFile();
-        cout << "Aplikasi berhasil diajukan. ID: " << id << endl;
+        Applicant app{id, name, address, region, now, "pending"};
+        cacheInsert(app);
+        cout << "Aplikasi diajukan. ID: " << id << " (dikirim ke server di latar belakang)" << endl;
+        return sendCommand("submit", ss.str(), "Pengajuan " + id, &app);
     }
 
-    void processVerification(const string& id) {
-        writeCommand("verify", id);
-        loadApplicationsFromFile();
-        cout << "Aplikasi '" << id << "' telah diverifikasi.\n";
+    shared_future<RemoteResult> processVerification(const string& id) {
+        KTP_TIMED(KtpMetric::Verify);
+        if (BstNode* node = cacheFind(id)) {
+            node->data.status = "verified"; // Status bukan kunci BST, cukup ubah di tempat
+        } else {
+            cacheStale = true; // Aplikasi belum ada di cache (dibuat oleh klien lain)
+        }
+        cout << "Verifikasi aplikasi '" << id << "' dikirim ke server.\n";
+        // Verifikasi ganda untuk ID yang sama yang belum terkirim cukup dikirim sekali
+        Applicant target;
+        target.id = id;
+        return sendCommand("verify", id, "Verifikasi " + id, &target, false, "verify|" + id);
     }
 
-    void editApplication(const string& id, const string& newName,
-                         const string& newAddress, const string& newRegion) {
+    shared_future<RemoteResult> editApplication(const string& id, const string& newName,
+                                                const string& newAddress, const string& newRegion) {
+        KTP_TIMED(KtpMetric::Edit);
         stringstream ss;
         ss << id << DELIMITER << newName << DELIMITER << newAddress << DELIMITER << newRegion;
-        writeCommand("edit", ss.str());
-        loadApplicationsFromFile();
-        cout << "Aplikasi diperbarui. ID: " << id << "\n";
+        Applicant updated;
+        updated.id = id;
+        updated.name = newName;
+        updated.address = newAddress;
+        updated.region = newRegion;
+        updated.status = "revision";
+        BstNode* node = cacheFind(id);
+        if (node == nullptr) {
+            cacheStale = true;
+        } else {
+            {
+                lock_guard<mutex> lock(optimisticMutex);
+                localRevisions[id].push_back(node->data);
+            }
+            applyOptimistic({"edit", updated});
+        }
+        cout << "Perubahan aplikasi '" << id << "' dikirim ke server.\n";
+        return sendCommand("edit", ss.str(), "Edit " + id, &updated);
     }
 
-    void undoRevision(const string& id) {
-        writeCommand("undo", id);
-        loadApplicationsFromFile();
-        cout << "Revisi dibatalkan untuk aplikasi '" << id << "'.\n";
+    // Bila revisi terakhir dibuat oleh edit di sesi ini, nilai sebelumnya sudah diketahui dan undo
+    // diterapkan langsung ke cache. Selain itu riwayat revisi hanya ada di server, jadi hasil undo
+    // diambil saat data dibaca berikutnya.
+    shared_future<RemoteResult> undoRevision(const string& id) {
+        KTP_TIMED(KtpMetric::Undo);
+        cout << "Pembatalan revisi aplikasi '" << id << "' dikirim ke server.\n";
+        Applicant previous;
+        bool known = false;
+        {
+            lock_guard<mutex> lock(optimisticMutex);
+            auto it = localRevisions.find(id);
+            if (it != localRevisions.end() && !it->second.empty()) {
+                previous = it->second.back();
+                it->second.pop_back();
+                known = true;
+            }
+        }
+        if (!known) {
+            return sendCommand("undo", id, "Undo " + id, nullptr, true);
+        }
+        applyOptimistic({"undo", previous});
+        return sendCommand("undo", id, "Undo " + id, &previous);
     }
 
     void displayAllApplications(const string& sortBy = "name") {
+        KTP_TIMED(KtpMetric::Display);
+        ensureFresh();
         vector<Applicant> apps;
         bstInOrderTraversal(bstRootByName, apps);
 
@@ -295,14 +585,10 @@ public:
         }
 
         if (sortBy == "region") {
-            sort(apps.begin(), apps.end(), [](const Applicant& a, const Applicant& b) {
-                return a.region < b.region;
-            });
+            sortByKeys<ktpsort::ByRegion, ktpsort::ByName>(apps, [](const Applicant& app) -> const Applicant& { return app; });
             cout << "\n--- Daftar Aplikasi KTP (Urut Region) --- (" << apps.size() << " aplikasi)\n";
         } else if (sortBy == "time") {
-            sort(apps.begin(), apps.end(), [](const Applicant& a, const Applicant& b) {
-                return a.submissionTime < b.submissionTime;
-            });
+            sortByKeys<ktpsort::ByTime>(apps, [](const Applicant& app) -> const Applicant& { return app; });
             cout << "\n--- Daftar Aplikasi KTP (Urut Waktu Pengajuan) --- (" << apps.size() << " aplikasi)\n";
         } else {
             cout << "\n--- Daftar Aplikasi KTP (Urut Nama via BST) --- (" << apps.size() << " aplikasi)\n";
@@ -318,14 +604,17 @@ public:
     }
 
     void refreshData() {
-        loadApplicationsFromFile(); // Muat ulang data dari database
+        KTP_TIMED(KtpMetric::Refresh);
+        loadApplicationsFromFile(); // Muat ulang data dari database, abaikan TTL
     }
 };
 
 int main() {
+    metrics().configureFromEnv();
     KtpSystem system;
 
     while (true) {
+        system.reportRemoteResults();
         cout << "\n=== Sistem Manajemen KTP (Berbasis Web) ==="
              << "\n1. Ajukan Aplikasi Baru"
              << "\n2. Proses Verifikasi"
@@ -335,7 +624,8 @@ int main() {
              << "\n6. Tampilkan Aplikasi (Urut Region)"
              << "\n7. Tampilkan Aplikasi (Urut Waktu Pengajuan)"
              << "\n8. Muat Ulang Data dari Server"
-             << "\n9. Keluar"
+             << "\n9. Tampilkan Statistik Kinerja"
+             << "\n0. Keluar"
              << "\nMasukkan pilihan: ";
 
         int choice;
@@ -349,7 +639,10 @@ int main() {
         }
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
-        if (choice == 9) {
+        if (choice == 0) {
+            if (system.pendingRemoteCommands() > 0) {
+                cout << "Mengirim perintah yang tertunda sebelum keluar..." << endl;
+            }
             cout << "Keluar dari sistem." << endl;
             break;
         }
@@ -391,6 +684,9 @@ int main() {
             case 8:
                 system.refreshData();
                 break;
+            case 9:
+                metrics().dumpStats(cout);
+                break;
             default:
                 cout << "Pilihan tidak valid. Silakan coba lagi.\n";
         }
@@ -7,8 +7,23 @@
 #include <list>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <filesystem> 
+#include <iomanip>
 #include <limits>     
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+
+#include "ktp_dedup.h"
+#include "ktp_import.h"
+#include "ktp_memory.h"
+#include "ktp_metrics.h"
+#include "ktp_server.h"
+#include "ktp_sort.h"
+#include "ktp_storage.h"
+#include "ktp_timeline.h"
 
 namespace fs = std::filesystem;
 using namespace std;
@@ -38,15 +53,316 @@ vector<string> split(const string& s, char delimiter) {
     return tokens;
 }
 
-// Struktur untuk Node BST
+// Satu baris format ktp_applications.txt / ktp_revisions.txt (diakhiri newline)
+string formatApplicantLine(const Applicant& app, char delimiter) {
+    return app.id + delimiter + app.name + delimiter + app.address + delimiter + app.region + delimiter +
+           to_string(app.submissionTime) + delimiter + app.status + "\n";
+}
+
+// Kebalikan formatApplicantLine; mengembalikan false bila jumlah kolom salah
+bool parseApplicantLine(const string& line, char delimiter, Applicant& app) {
+    vector<string> tokens = split(line, delimiter);
+    if (tokens.size() != 6) return false;
+    app.id = tokens[0]; app.name = tokens[1]; app.address = tokens[2];
+    app.region = tokens[3];
+    try { app.submissionTime = stoll(tokens[4]); } catch (const std::exception&) { app.submissionTime = time(nullptr); }
+    app.status = tokens[5];
+    return true;
+}
+
+// Struktur untuk Node BST. Dalam KTP_CAPACITY_MODE nama tidak disalin ke node: kunci dibaca
+// lewat applicantIter, menghemat satu string per aplikasi dengan biaya satu dereferensi
+// tambahan per perbandingan.
 struct BstNode {
     list<Applicant>::iterator applicantIter; // Iterator ke Applicant di applicationQueue
+#ifndef KTP_CAPACITY_MODE
     string keyName; // Nama pemohon sebagai kunci BST
+#endif
     BstNode *left;
     BstNode *right;
 
     BstNode(list<Applicant>::iterator iter)
-        : applicantIter(iter), keyName(iter->name), left(nullptr), right(nullptr) {}
+        : applicantIter(iter), left(nullptr), right(nullptr) {
+#ifndef KTP_CAPACITY_MODE
+        keyName = iter->name;
+#endif
+    }
+
+    const string& key() const {
+#ifdef KTP_CAPACITY_MODE
+        return applicantIter->name;
+#else
+        return keyName;
+#endif
+    }
+};
+
+// Riwayat revisi per aplikasi (stack; revisi terbaru di belakang). Dalam KTP_CAPACITY_MODE
+// revisi diperlakukan sebagai data dingin: barisnya ditulis ke SpillFile dan di memori hanya
+// tersisa SpillRef, bukan salinan Applicant lengkap dengan enam string. File spill dipadatkan
+// setelah pop bila sampahnya menumpuk, kecuali selama pin() aktif (salinan all() masih dibaca).
+class RevisionHistory {
+public:
+#ifdef KTP_CAPACITY_MODE
+    using Stored = SpillRef;
+#else
+    using Stored = Applicant;
+#endif
+    using Entries = unordered_map<string, vector<Stored>>;
+
+    // spillPath hanya dipakai dalam KTP_CAPACITY_MODE
+    void clear(const fs::path& spillPath) {
+        entries.clear();
+        total = 0;
+#ifdef KTP_CAPACITY_MODE
+        spill.open(spillPath);
+#else
+        (void)spillPath;
+#endif
+    }
+
+    void push(const string& id, const Applicant& app) {
+        ++total;
+#ifdef KTP_CAPACITY_MODE
+        entries[id].push_back(spill.append(formatApplicantLine(app, DELIMITER)));
+#else
+        entries[id].push_back(app);
+#endif
+    }
+
+    // Mengambil revisi terakhir; mengembalikan false bila tidak ada atau tidak bisa dibaca dari
+    // file spill (revisi tetap di stack)
+    bool pop(const string& id, Applicant& app) {
+        auto it = entries.find(id);
+        if (it == entries.end() || it->second.empty()) return false;
+#ifdef KTP_CAPACITY_MODE
+        string line = spill.read(it->second.back());
+        if (line.empty() || line.back() != '\n') return false;
+        line.pop_back();
+        if (!parseApplicantLine(line, DELIMITER, app)) return false;
+        spill.release(it->second.back());
+#else
+        app = it->second.back();
+#endif
+        it->second.pop_back();
+        if (it->second.empty()) entries.erase(it);
+        --total;
+        compactIfNeeded();
+        return true;
+    }
+
+    // Selama ada pin, ref hasil all() tetap valid (kompaksi ditunda). Dipanggil di bawah stateMutex.
+    void pin() {
+        ++pins;
+    }
+
+    void unpin() {
+        --pins;
+        compactIfNeeded();
+    }
+
+    size_t count(const string& id) const {
+        auto it = entries.find(id);
+        return it == entries.end() ? 0 : it->second.size();
+    }
+
+    // Salinan untuk writeSnapshot; baris tiap revisi dibaca lewat format() di luar lock
+    const Entries& all() const {
+        return entries;
+    }
+
+    // "" bila revisi tidak bisa dibaca dari file spill
+    string format(const Stored& revision) const {
+#ifdef KTP_CAPACITY_MODE
+        return spill.read(revision);
+#else
+        return formatApplicantLine(revision, DELIMITER);
+#endif
+    }
+
+    // Blok ktp_revisions.txt untuk satu ID ("<id>\n<jumlah>\n" + baris revisi), "" bila kosong
+    // atau bila ada revisi yang tidak bisa dibaca
+    string formatBlock(const string& id) const {
+        auto it = entries.find(id);
+        if (it == entries.end()) return "";
+        string block = id + "\n" + to_string(it->second.size()) + "\n";
+        for (const auto& revision : it->second) {
+            string line = format(revision);
+            if (line.empty()) return "";
+            block += line;
+        }
+        return block;
+    }
+
+    size_t size() const {
+        return total;
+    }
+
+    size_t memoryBytes() const {
+        size_t bytes = ktpmem::hashTableBytes(entries);
+        for (const auto& entry : entries) {
+            bytes += ktpmem::stringHeapBytes(entry.first) + ktpmem::vectorBytes(entry.second);
+#ifndef KTP_CAPACITY_MODE
+            for (const auto& app : entry.second) {
+                bytes += ktpmem::stringHeapBytes(app.id) + ktpmem::stringHeapBytes(app.name) +
+                         ktpmem::stringHeapBytes(app.address) + ktpmem::stringHeapBytes(app.region) +
+                         ktpmem::stringHeapBytes(app.status);
+            }
+#endif
+        }
+        return bytes;
+    }
+
+    uint64_t spillBytes() const {
+#ifdef KTP_CAPACITY_MODE
+        return spill.fileBytes();
+#else
+        return 0;
+#endif
+    }
+
+private:
+    static constexpr char DELIMITER = '\t';
+    Entries entries;
+    size_t total = 0; // Jumlah revisi di semua ID
+    int pins = 0;
+#ifdef KTP_CAPACITY_MODE
+    SpillFile spill;
+#endif
+
+    void compactIfNeeded() {
+#ifdef KTP_CAPACITY_MODE
+        if (pins > 0 || !spill.needsCompaction()) return;
+        vector<SpillRef*> live;
+        live.reserve(total);
+        for (auto& entry : entries) {
+            for (auto& ref : entry.second) live.push_back(&ref);
+        }
+        spill.compact(live);
+#endif
+    }
+};
+
+// Kolom file impor. Tanpa header: 3 kolom = name, address, region; 6 kolom = format ktp_applications.txt
+struct ImportColumns {
+    int id = -1, name = -1, address = -1, region = -1, submissionTime = -1, status = -1;
+    size_t count = 0; // Jumlah kolom yang diharapkan; 0 = ditentukan dari baris data
+
+    // Mengembalikan true bila fields adalah baris header
+    bool readHeader(const vector<string>& fields) {
+        vector<string> names;
+        for (const auto& field : fields) {
+            string name = trimImportField(field);
+            transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+            names.push_back(name);
+        }
+        if (find(names.begin(), names.end(), "name") == names.end()) return false;
+        for (size_t i = 0; i < names.size(); ++i) {
+            int index = static_cast<int>(i);
+            if (names[i] == "id") id = index;
+            else if (names[i] == "name") name = index;
+            else if (names[i] == "address") address = index;
+            else if (names[i] == "region") region = index;
+            else if (names[i] == "submission_time") submissionTime = index;
+            else if (names[i] == "status") status = index;
+        }
+        count = names.size();
+        return true;
+    }
+
+    bool forFieldCount(size_t fieldCount) {
+        if (count != 0) return fieldCount == count;
+        if (fieldCount == 3) {
+            *this = ImportColumns();
+            name = 0; address = 1; region = 2;
+        } else if (fieldCount == 6) {
+            *this = ImportColumns();
+            id = 0; name = 1; address = 2; region = 3; submissionTime = 4; status = 5;
+        } else {
+            return false;
+        }
+        return true;
+    }
+};
+
+struct ImportedRow {
+    Applicant app;
+    string error; // Kosong bila baris valid
+    bool blank = false;
+};
+
+struct ImportReject {
+    size_t lineNumber;
+    string reason;
+    string line;
+};
+
+struct ImportSummary {
+    bool opened = false;
+    size_t rowsRead = 0;
+    size_t accepted = 0;
+    size_t rejected = 0;
+    double seconds = 0.0;
+    string rejectPath;
+};
+
+// Mem-parse dan memvalidasi satu baris impor. Tidak menyentuh state KtpSystem, sehingga aman
+// dipanggil dari beberapa thread sekaligus.
+ImportedRow parseImportRow(const string& line, char delimiter, ImportColumns columns, time_t now) {
+    ImportedRow row;
+    if (trimImportField(line).empty()) {
+        row.blank = true;
+        return row;
+    }
+    vector<string> fields = splitImportLine(line, delimiter);
+    if (!columns.forFieldCount(fields.size())) {
+        row.error = "jumlah kolom tidak valid (" + to_string(fields.size()) + ")";
+        return row;
+    }
+    auto field = [&](int index) { return index < 0 ? string() : trimImportField(fields[static_cast<size_t>(index)]); };
+
+    Applicant& app = row.app;
+    app.id = field(columns.id);
+    app.name = field(columns.name);
+    app.address = field(columns.address);
+    app.region = field(columns.region);
+    app.status = field(columns.status);
+    if (app.status.empty()) app.status = "pending";
+    if (app.name.empty() || app.address.empty() || app.region.empty()) {
+        row.error = "name, address, dan region wajib diisi";
+        return row;
+    }
+    for (const string* value : {&app.id, &app.name, &app.address, &app.region}) {
+        if (value->find_first_of("\t\n\r") != string::npos) {
+            row.error = "field tidak boleh berisi tab";
+            return row;
+        }
+    }
+    if (app.status != "pending" && app.status != "verified" && app.status != "revision") {
+        row.error = "status tidak valid: " + app.status;
+        return row;
+    }
+    app.submissionTime = now;
+    string timeText = field(columns.submissionTime);
+    if (!timeText.empty()) {
+        size_t used = 0;
+        try {
+            app.submissionTime = static_cast<time_t>(stoll(timeText, &used));
+        } catch (const std::exception&) {
+            used = 0;
+        }
+        if (used != timeText.size()) {
+            row.error = "submission_time tidak valid: " + timeText;
+            return row;
+        }
+    }
+    return row;
+}
+
+// Satu halaman hasil listApplications; total adalah jumlah seluruh aplikasi
+struct ApplicationPage {
+    size_t total = 0;
+    vector<Applicant> applications;
 };
 
 // Kelas untuk mengelola aplikasi KTP
@@ -56,20 +372,48 @@ private:
     unordered_map<string, list<Applicant>::iterator> applicationMap; // Hash Table (ID -> Iterator)
     BstNode* bstRootByName; // Root dari Binary Search Tree berdasarkan nama
 
-    unordered_map<string, vector<Applicant>> revisionStack;
+    RevisionHistory revisionStack;
     string dataFilePath;
     string revisionFilePath;
     string projectRoot;
     const char DELIMITER = '\t';
 
+    static constexpr const char* APPLICATIONS_FILE = "ktp_applications.txt";
+    static constexpr const char* REVISIONS_FILE = "ktp_revisions.txt";
+
+    // Dikunci oleh operasi yang mengubah data dan oleh writeSnapshot saat menyalin data
+    mutable mutex stateMutex;
+    KtpSnapshotStore snapshotStore;
+    unique_ptr<SnapshotWriter> snapshotWriter;
+
+    // --- Snapshot delta (dikunci oleh stateMutex) ---
+    // Mutasi hanya mencatat ID yang berubah. writeSnapshot menyalin baris aplikasi dan revisi
+    // untuk ID tersebut saja, lalu menggabungkannya dengan file snapshot sebelumnya di luar lock,
+    // sehingga lock tidak ditahan O(n). Urutan antrian yang berubah (sortBy*), file yang dimuat
+    // tidak bersih, atau snapshot yang gagal membuat snapshot berikutnya menyalin seluruh state.
+    vector<string> dirtyIds; // Urutan pertama kali berubah; ID baru ditambahkan ke akhir file
+    unordered_set<string> dirtyIdSet;
+    bool fullSnapshotNeeded = false;
+    atomic<uint64_t> lastSnapshotLockNanos{0};
+
+    struct SnapshotChange {
+        string id;
+        string applicationLine;
+        string revisionBlock; // "" bila ID tidak punya revisi lagi
+        size_t revisions = 0;
+    };
+
+    ActivityTimeline timeline; // Riwayat submit/verifikasi/edit/undo beserta waktunya
+    DedupIndex dedupIndex; // Blocking index untuk mendeteksi pemohon ganda
+
     // --- Operasi BST ---
     BstNode* bstInsert(BstNode* node, list<Applicant>::iterator appIter) {
         if (node == nullptr) {
             return new BstNode(appIter);
         }
-        if (appIter->name < node->keyName) {
+        if (appIter->name < node->key()) {
             node->left = bstInsert(node->left, appIter);
-        } else { // appIter->name >= node->keyName
+        } else { // appIter->name >= node->key()
             node->right = bstInsert(node->right, appIter);
         }
         return node;
@@ -84,16 +428,22 @@ private:
     
     // Menghapus node BST yang spesifik berdasarkan iteratornya (untuk nama yang sama tapi iterator berbeda)
     BstNode* bstRemove(BstNode* node, const string& nameToRemove, list<Applicant>::iterator iterToRemove) {
+        bool removed = false;
+        return bstRemove(node, nameToRemove, iterToRemove, removed);
+    }
+
+    BstNode* bstRemove(BstNode* node, const string& nameToRemove, list<Applicant>::iterator iterToRemove, bool& removed) {
         if (node == nullptr) {
             return nullptr;
         }
 
-        if (nameToRemove < node->keyName) {
-            node->left = bstRemove(node->left, nameToRemove, iterToRemove);
-        } else if (nameToRemove > node->keyName) {
-            node->right = bstRemove(node->right, nameToRemove, iterToRemove);
+        if (nameToRemove < node->key()) {
+            node->left = bstRemove(node->left, nameToRemove, iterToRemove, removed);
+        } else if (nameToRemove > node->key()) {
+            node->right = bstRemove(node->right, nameToRemove, iterToRemove, removed);
         } else {
             if (node->applicantIter == iterToRemove) {
+                removed = true;
                 if (node->left == nullptr && node->right == nullptr) {
                     delete node;
                     return nullptr;
@@ -108,18 +458,23 @@ private:
                 }
                 BstNode* temp = bstFindMin(node->right);
                 node->applicantIter = temp->applicantIter;
+#ifndef KTP_CAPACITY_MODE
                 node->keyName = temp->keyName;
+#endif
                 // Hapus inorder successor
-                node->right = bstRemove(node->right, temp->keyName, temp->applicantIter);
-            } else { // Nama sama tapi iterator beda, cari di sub-pohon kanan
-                node->right = bstRemove(node->right, nameToRemove, iterToRemove);
+                node->right = bstRemove(node->right, temp->key(), temp->applicantIter);
+            } else { // Nama sama tapi iterator beda; setelah bstBuildBalanced nama sama bisa ada di kedua sisi
+                node->right = bstRemove(node->right, nameToRemove, iterToRemove, removed);
+                if (!removed) {
+                    node->left = bstRemove(node->left, nameToRemove, iterToRemove, removed);
+                }
             }
         }
         return node;
     }
 
 
-    void bstInOrderTraversal(BstNode* node, vector<list<Applicant>::iterator>& result) {
+    void bstInOrderTraversal(BstNode* node, vector<list<Applicant>::iterator>& result) const {
         if (node != nullptr) {
             bstInOrderTraversal(node->left, result);
             result.push_back(node->applicantIter);
@@ -127,6 +482,61 @@ private:
         }
     }
 
+    // Menyalin node in-order ke-[skip, skip+limit) tanpa menelusuri sisa pohon
+    void bstCopyWindow(BstNode* node, size_t& skip, size_t limit, vector<Applicant>& result) const {
+        if (node == nullptr || result.size() >= limit) return;
+        bstCopyWindow(node->left, skip, limit, result);
+        if (result.size() >= limit) return;
+        if (skip > 0) {
+            --skip;
+        } else {
+            result.push_back(*node->applicantIter);
+        }
+        bstCopyWindow(node->right, skip, limit, result);
+    }
+
+    void bstCollectNodes(BstNode* node, vector<BstNode*>& result) {
+        if (node != nullptr) {
+            bstCollectNodes(node->left, result);
+            result.push_back(node);
+            bstCollectNodes(node->right, result);
+        }
+    }
+
+    // Menyusun pohon seimbang dari node yang sudah terurut nama
+    BstNode* bstBuildBalanced(vector<BstNode*>& nodes, size_t begin, size_t end) {
+        if (begin >= end) {
+            return nullptr;
+        }
+        size_t mid = begin + (end - begin) / 2;
+        BstNode* node = nodes[mid];
+        node->left = bstBuildBalanced(nodes, begin, mid);
+        node->right = bstBuildBalanced(nodes, mid + 1, end);
+        return node;
+    }
+
+    // Merge bulk: node lama (in-order) digabung dengan aplikasi baru yang sudah diurutkan nama,
+    // lalu pohon disusun ulang seimbang. O(n + k log k), bukan k kali bstInsert.
+    void bstMergeBulk(vector<list<Applicant>::iterator> added) {
+        sortByKeys<ktpsort::ByName>(added, [](list<Applicant>::iterator it) -> const Applicant& { return *it; });
+        vector<BstNode*> existing;
+        bstCollectNodes(bstRootByName, existing);
+
+        vector<BstNode*> merged;
+        merged.reserve(existing.size() + added.size());
+        size_t i = 0;
+        for (auto it : added) {
+            while (i < existing.size() && existing[i]->key() <= it->name) {
+                merged.push_back(existing[i++]);
+            }
+            merged.push_back(new BstNode(it));
+        }
+        while (i < existing.size()) {
+            merged.push_back(existing[i++]);
+        }
+        bstRootByName = bstBuildBalanced(merged, 0, merged.size());
+    }
+
     void bstClear(BstNode* node) {
         if (node == nullptr) {
             return;
@@ -138,8 +548,25 @@ private:
     // --- Akhir Operasi BST ---
 
 
+    // ID berbasis region + waktu; diberi akhiran bila beberapa aplikasi diajukan pada detik yang sama
     string generateId(const string& region) {
-        return region + "-" + to_string(time(nullptr));
+        string base = region + "-" + to_string(time(nullptr));
+        string id = base;
+        for (int suffix = 2; applicationMap.count(id) > 0; ++suffix) {
+            id = base + "-" + to_string(suffix);
+        }
+        return id;
+    }
+
+    void warnDuplicates(const vector<DuplicateMatch>& matches, size_t skipped) {
+        for (const auto& match : matches) {
+            cout << "Peringatan: kemungkinan pemohon ganda dengan ID " << match.id << " (kemiripan "
+                 << static_cast<int>(match.score * 100 + 0.5) << "%).\n";
+        }
+        if (skipped > 0) {
+            cout << "Catatan: " << skipped << " pemohon dengan nama/alamat serupa tidak diperiksa (bucket melebihi "
+                 << DedupIndex::MAX_CANDIDATES_PER_BUCKET << " kandidat); jalankan pencarian batch (menu 12).\n";
+        }
     }
 
     void ensureDataDir() {
@@ -168,58 +595,65 @@ private:
             return;
         }
 
-        string line;
-        while (getline(file, line)) {
-            vector<string> tokens = split(line, DELIMITER);
-            if (tokens.size() == 6) {
-                Applicant app;
-                app.id = tokens[0];
-                app.name = tokens[1];
-                app.address = tokens[2];
-                app.region = tokens[3];
-                try {
-                    app.submissionTime = stoll(tokens[4]);
-                } catch (const std::exception& e) {
-                    cerr << "Format submissionTime tidak valid untuk ID " << app.id << ": " << tokens[4] << endl;
-                    app.submissionTime = time(nullptr);
+        {
+            KTP_TIMED(KtpMetric::Parse);
+            string line;
+            while (getline(file, line)) {
+                vector<string> tokens = split(line, DELIMITER);
+                if (tokens.size() == 6) {
+                    Applicant app;
+                    app.id = tokens[0];
+                    app.name = tokens[1];
+                    app.address = tokens[2];
+                    app.region = tokens[3];
+                    try {
+                        app.submissionTime = stoll(tokens[4]);
+                    } catch (const std::exception& e) {
+                        cerr << "Format submissionTime tidak valid untuk ID " << app.id << ": " << tokens[4] << endl;
+                        app.submissionTime = time(nullptr);
+                    }
+                    app.status = tokens[5];
+                    applicationQueue.push_back(app);
+                } else {
+                    cerr << "Baris tidak valid di file aplikasi: " << line << endl;
+                    fullSnapshotNeeded = true; // File di disk tidak bisa dipakai sebagai dasar delta
                 }
-                app.status = tokens[5];
-
-                applicationQueue.push_back(app);
-                list<Applicant>::iterator currentIter = prev(applicationQueue.end());
-                applicationMap[app.id] = currentIter;
-                bstRootByName = bstInsert(bstRootByName, currentIter); // Tambahkan ke BST
-            } else {
-                cerr << "Baris tidak valid di file aplikasi: " << line << endl;
             }
         }
-        cout << "Memuat " << applicationQueue.size() << " aplikasi dari '" << dataFilePath << "'" << endl;
-        file.close();
-    }
 
-    void saveApplicationsToFile() {
-        ensureDataDir();
-        ofstream file(dataFilePath);
-        if (!file.is_open()) {
-            cerr << "Tidak bisa membuka file untuk menulis: " << dataFilePath << endl;
-            return;
-        }
+        {
+            KTP_TIMED(KtpMetric::Index);
+            vector<list<Applicant>::iterator> loaded;
+            loaded.reserve(applicationQueue.size());
+            for (auto it = applicationQueue.begin(); it != applicationQueue.end(); ++it) {
+                applicationMap[it->id] = it;
+                bstRootByName = bstInsert(bstRootByName, it); // Tambahkan ke BST
+                loaded.push_back(it);
+            }
+            if (applicationMap.size() != applicationQueue.size()) {
+                fullSnapshotNeeded = true; // ID ganda di file: delta per ID tidak bisa dipetakan ke baris
+            }
 
-        for (const auto& app : applicationQueue) {
-            file << app.id << DELIMITER
-                 << app.name << DELIMITER
-                 << app.address << DELIMITER
-                 << app.region << DELIMITER
-                 << app.submissionTime << DELIMITER
-                 << app.status << endl;
-        }
-        cout << "Menyimpan " << applicationQueue.size() << " aplikasi ke '" << dataFilePath << "'" << endl;
+            // Normalisasi untuk indeks duplikat adalah bagian termahal, jadi dikerjakan paralel
+            vector<NormalizedApplicant> normalized(loaded.size());
+            parallelRanges(loaded.size(), [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    normalized[i] = normalizeApplicant(loaded[i]->name, loaded[i]->address, loaded[i]->region);
+                }
+            });
+            dedupIndex.clear();
+            dedupIndex.reserve(loaded.size());
+            for (size_t i = 0; i < loaded.size(); ++i) {
+                dedupIndex.add(loaded[i]->id, move(normalized[i]));
+            }
+        }
+        cout << "Memuat " << applicationQueue.size() << " aplikasi dari '" << dataFilePath << "'" << endl;
         file.close();
     }
 
     void loadRevisionsFromFile() {
         ensureDataDir();
-        revisionStack.clear();
+        revisionStack.clear(fs::path(projectRoot) / "data" / "ktp_revisions.spill");
         ifstream file(revisionFilePath);
         if (!file.is_open()) { cout << "File revisi tidak ditemukan." << endl; 
             return; 
@@ -227,69 +661,240 @@ private:
         string line;
         while (getline(file, line)) {
             string originalAppId = line;
-            if (!getline(file, line)) break;
+            if (!getline(file, line)) { fullSnapshotNeeded = true; break; }
             int revisionCount;
-            try { revisionCount = stoi(line); } catch (const std::exception&) { continue; }
-            vector<Applicant> appRevisions;
+            try { revisionCount = stoi(line); } catch (const std::exception&) { fullSnapshotNeeded = true; continue; }
             for (int i = 0; i < revisionCount; ++i) {
-                if (!getline(file, line)) break;
-                vector<string> tokens = split(line, DELIMITER);
-                if (tokens.size() == 6) {
-                    Applicant app;
-                    app.id = tokens[0]; app.name = tokens[1]; app.address = tokens[2];
-                    app.region = tokens[3];
-                    try { app.submissionTime = stoll(tokens[4]); } catch (const std::exception&) { app.submissionTime = time(nullptr); }
-                    app.status = tokens[5];
-                    appRevisions.push_back(app);
+                if (!getline(file, line)) { fullSnapshotNeeded = true; break; }
+                Applicant app;
+                if (parseApplicantLine(line, DELIMITER, app)) {
+                    revisionStack.push(originalAppId, app);
+                } else {
+                    fullSnapshotNeeded = true;
                 }
             }
-            if (!appRevisions.empty() || revisionCount == 0) { revisionStack[originalAppId] = appRevisions; }
         }
         file.close();
     }
 
-    void saveRevisionsToFile() {
-        ensureDataDir();
-        ofstream file(revisionFilePath);
-        if (!file.is_open()) { 
-            cerr << "Tidak bisa membuka file revisi." << endl; 
-            return; 
-        }
-        for (const auto& pair : revisionStack) {
-            file << pair.first << endl;
-            file << pair.second.size() << endl;
-            for (const auto& app : pair.second) {
-                file << app.id << DELIMITER << app.name << DELIMITER << app.address << DELIMITER
-                     << app.region << DELIMITER << app.submissionTime << DELIMITER << app.status << endl;
+    string formatApplicant(const Applicant& app) const {
+        return formatApplicantLine(app, DELIMITER);
+    }
+
+    // Dipanggil di bawah stateMutex oleh setiap mutasi
+    void markDirty(const string& id) {
+        if (!fullSnapshotNeeded && dirtyIdSet.insert(id).second) dirtyIds.push_back(id);
+    }
+
+    // Mencatat lama stateMutex ditahan oleh writeSnapshot (metrik snapshot_lock, ktp_benchmark)
+    void recordSnapshotLock(chrono::steady_clock::time_point start) {
+        uint64_t nanos = static_cast<uint64_t>(
+            chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+        lastSnapshotLockNanos = nanos;
+        if (metrics().enabled()) metrics().record(KtpMetric::SnapshotLock, nanos);
+    }
+
+    // Dipanggil oleh SnapshotWriter di thread latar belakang. Di bawah lock hanya ID yang berubah
+    // sejak snapshot terakhir yang disalin; penggabungan, fsync dan rename berjalan tanpa lock.
+    // Baris log aktivitas yang terkumpul sejak snapshot sebelumnya ikut ditulis di sini.
+    void writeSnapshot() {
+        KTP_TIMED(KtpMetric::Persist);
+        vector<SnapshotChange> changes;
+        size_t applicationCount = 0;
+        size_t revisionCount = 0;
+        string activityLog;
+        bool full;
+        {
+            lock_guard<mutex> lock(stateMutex);
+            auto lockStart = chrono::steady_clock::now();
+            activityLog = timeline.takePendingLog();
+            full = fullSnapshotNeeded;
+            if (!full) {
+                changes.reserve(dirtyIds.size());
+                for (const auto& id : dirtyIds) {
+                    auto map_it = applicationMap.find(id);
+                    if (map_it == applicationMap.end()) continue;
+                    SnapshotChange change;
+                    change.id = id;
+                    change.applicationLine = formatApplicant(*map_it->second);
+                    change.revisionBlock = revisionStack.formatBlock(id);
+                    change.revisions = revisionStack.count(id);
+                    if (change.revisions > 0 && change.revisionBlock.empty()) full = true; // Spill tidak terbaca
+                    changes.push_back(move(change));
+                }
+                applicationCount = applicationQueue.size();
+                revisionCount = revisionStack.size();
+                dirtyIds.clear();
+                dirtyIdSet.clear();
             }
+            recordSnapshotLock(lockStart);
+        }
+        timeline.appendToLog(activityLog);
+        if (full || !commitDelta(changes, applicationCount, revisionCount)) {
+            writeFullSnapshot();
+        }
+    }
+
+    // Menulis file baru dari file snapshot sebelumnya: baris ID yang berubah diganti, ID baru
+    // ditambahkan di akhir. Bila jumlah baris hasilnya tidak cocok dengan state (mis. file diubah
+    // dari luar), file ditandai gagal sehingga commit dibatalkan dan pemanggil menulis ulang penuh.
+    bool commitDelta(const vector<SnapshotChange>& changes, size_t applicationCount, size_t revisionCount) {
+        unordered_map<string, const SnapshotChange*> byId;
+        byId.reserve(changes.size());
+        for (const auto& change : changes) byId[change.id] = &change;
+
+        return snapshotStore.commit({
+            {APPLICATIONS_FILE, [&](DurableFileWriter& file) {
+                unordered_set<string> written;
+                size_t lines = 0;
+                ifstream previous(dataFilePath);
+                string line;
+                while (getline(previous, line)) {
+                    auto change = byId.find(line.substr(0, line.find(DELIMITER)));
+                    if (change == byId.end()) {
+                        file.append(line);
+                        file.append("\n");
+                    } else {
+                        file.append(change->second->applicationLine);
+                        written.insert(change->first);
+                    }
+                    ++lines;
+                }
+                for (const auto& change : changes) {
+                    if (written.count(change.id) > 0) continue;
+                    file.append(change.applicationLine);
+                    ++lines;
+                }
+                if (lines != applicationCount) file.fail();
+            }},
+            {REVISIONS_FILE, [&](DurableFileWriter& file) {
+                unordered_set<string> written;
+                size_t total = 0;
+                ifstream previous(revisionFilePath);
+                string id, countText, line;
+                while (getline(previous, id) && getline(previous, countText)) {
+                    size_t count = 0;
+                    try { count = stoul(countText); } catch (const std::exception&) { file.fail(); return; }
+                    auto change = byId.find(id);
+                    if (change == byId.end()) file.append(id + "\n" + countText + "\n");
+                    for (size_t i = 0; i < count; ++i) {
+                        if (!getline(previous, line)) { file.fail(); return; }
+                        if (change != byId.end()) continue;
+                        file.append(line);
+                        file.append("\n");
+                        ++total;
+                    }
+                    if (change != byId.end() && written.insert(id).second) {
+                        file.append(change->second->revisionBlock);
+                        total += change->second->revisions;
+                    }
+                }
+                for (const auto& change : changes) {
+                    if (written.count(change.id) > 0) continue;
+                    file.append(change.revisionBlock);
+                    total += change.revisions;
+                }
+                if (total != revisionCount) file.fail();
+            }},
+        });
+    }
+
+    // Snapshot lengkap: seluruh antrian dan revisi disalin di bawah lock (O(n)). Hanya dipakai
+    // setelah urutan antrian berubah atau bila snapshot delta tidak bisa ditulis.
+    void writeFullSnapshot() {
+        vector<Applicant> apps;
+        RevisionHistory::Entries revisions;
+        {
+            lock_guard<mutex> lock(stateMutex);
+            auto lockStart = chrono::steady_clock::now();
+            apps.assign(applicationQueue.begin(), applicationQueue.end());
+            revisions = revisionStack.all();
+            revisionStack.pin(); // Ref di salinan dibaca di luar lock
+            dirtyIds.clear();
+            dirtyIdSet.clear();
+            fullSnapshotNeeded = false;
+            recordSnapshotLock(lockStart);
+        }
+
+        bool committed = snapshotStore.commit({
+            {APPLICATIONS_FILE, [&](DurableFileWriter& file) {
+                for (const auto& app : apps) {
+                    file.append(formatApplicant(app));
+                }
+            }},
+            {REVISIONS_FILE, [&](DurableFileWriter& file) {
+                for (const auto& pair : revisions) {
+                    file.append(pair.first + "\n" + to_string(pair.second.size()) + "\n");
+                    for (const auto& revision : pair.second) {
+                        string line = revisionStack.format(revision);
+                        if (line.empty()) { file.fail(); return; }
+                        file.append(line);
+                    }
+                }
+            }},
+        });
+        lock_guard<mutex> lock(stateMutex);
+        revisionStack.unpin();
+        if (!committed) {
+            fullSnapshotNeeded = true; // File di disk mungkin tidak cocok lagi sebagai dasar delta
         }
-        file.close();
     }
     
-    void rebuildMap() {
-        applicationMap.clear();
+    // Memuat log aktivitas; bila belum ada, timeline diisi dari waktu pengajuan aplikasi yang ada
+    void loadTimeline() {
+        string eventsPath = (fs::path(projectRoot) / "data" / "ktp_events.txt").string();
+        if (!timeline.load(eventsPath)) {
+            vector<ActivityEvent> initial;
+            initial.reserve(applicationQueue.size());
+            for (const auto& app : applicationQueue) {
+                initial.push_back({app.submissionTime, ActivityType::Submitted, app.id});
+            }
+            timeline.backfill(move(initial));
+        }
+    }
+
+    // Menyusun ulang applicationQueue sesuai urutan Keys... Node list hanya dipindah (splice),
+    // sehingga iterator di applicationMap dan BST tetap valid.
+    template <typename... Keys>
+    void reorderQueue() {
+        vector<list<Applicant>::iterator> order;
+        order.reserve(applicationQueue.size());
         for (auto it = applicationQueue.begin(); it != applicationQueue.end(); ++it) {
-            applicationMap[it->id] = it;
+            order.push_back(it);
         }
+        sortByKeys<Keys...>(order, [](list<Applicant>::iterator it) -> const Applicant& { return *it; });
+        for (auto it : order) {
+            applicationQueue.splice(applicationQueue.end(), applicationQueue, it);
+        }
+        fullSnapshotNeeded = true; // Urutan baris di file ikut berubah
     }
 
 public:
-    KtpSystem() : bstRootByName(nullptr) {
-        projectRoot = fs::current_path().string();
-        dataFilePath = (fs::path(projectRoot) / "data" / "ktp_applications.txt").string();
-        revisionFilePath = (fs::path(projectRoot) / "data" / "ktp_revisions.txt").string();
+    // rootDir: direktori yang berisi folder 'data/' (default: direktori kerja saat ini)
+    explicit KtpSystem(const string& rootDir = fs::current_path().string())
+        : bstRootByName(nullptr), snapshotStore(fs::path(rootDir) / "data") {
+        projectRoot = rootDir;
+        dataFilePath = (fs::path(projectRoot) / "data" / APPLICATIONS_FILE).string();
+        revisionFilePath = (fs::path(projectRoot) / "data" / REVISIONS_FILE).string();
 
         cout << "Inisialisasi Sistem KTP..." << endl;
+        snapshotStore.recover({APPLICATIONS_FILE, REVISIONS_FILE});
         loadApplicationsFromFile();
         loadRevisionsFromFile();
+        loadTimeline();
+        snapshotWriter = make_unique<SnapshotWriter>([this]() { writeSnapshot(); });
         cout << "Sistem KTP Diinisialisasi." << endl;
     }
 
     ~KtpSystem() {
+        snapshotWriter.reset(); // Tulis snapshot yang tertunda sebelum data dibebaskan
         bstClear(bstRootByName);
     }
 
-    void submitApplication(const string& name, const string& address, const string& region) {
+    // Mengembalikan ID aplikasi baru
+    string submitApplication(const string& name, const string& address, const string& region) {
+        KTP_TIMED(KtpMetric::Submit);
+        lock_guard<mutex> lock(stateMutex);
         Applicant newApp;
         newApp.id = generateId(region);
         newApp.name = name;
@@ -297,42 +902,58 @@ public:
         newApp.region = region;
         newApp.submissionTime = time(nullptr);
         newApp.status = "pending";
+        size_t skipped = 0;
+        vector<DuplicateMatch> duplicates = dedupIndex.findMatches(name, address, region, "", &skipped);
 
         applicationQueue.push_back(newApp);
         list<Applicant>::iterator currentIter = prev(applicationQueue.end());
         applicationMap[newApp.id] = currentIter;
         bstRootByName = bstInsert(bstRootByName, currentIter);
+        dedupIndex.add(newApp.id, name, address, region);
+        timeline.record(newApp.submissionTime, ActivityType::Submitted, newApp.id);
 
-        saveApplicationsToFile();
+        markDirty(newApp.id);
+        snapshotWriter->schedule();
         cout << "Aplikasi berhasil diajukan. ID: " << newApp.id << endl;
+        warnDuplicates(duplicates, skipped);
+        return newApp.id;
     }
 
-    void processVerification(const string& id) {
+    // Mengembalikan false bila ID tidak ditemukan
+    bool processVerification(const string& id) {
+        KTP_TIMED(KtpMetric::Verify);
+        lock_guard<mutex> lock(stateMutex);
         auto map_it = applicationMap.find(id);
         if (map_it == applicationMap.end()) {
             cout << "Aplikasi dengan ID '" << id << "' tidak ditemukan.\n";
-            return;
+            return false;
         }
         auto app_it = map_it->second;
         if (app_it->status == "verified") { cout << "Aplikasi sudah diverifikasi.\n";
-            return; 
+            return true; 
         }
         app_it->status = "verified";
-        saveApplicationsToFile();
+        timeline.record(time(nullptr), ActivityType::Verified, id);
+        markDirty(id);
+        snapshotWriter->schedule();
         cout << "Aplikasi '" << id << "' telah diverifikasi.\n";
+        return true;
     }
 
-    void editApplication(const string& id, const string& newName,
+    // Mengembalikan false bila ID tidak ditemukan
+    bool editApplication(const string& id, const string& newName,
                          const string& newAddress, const string& newRegion) {
+        KTP_TIMED(KtpMetric::Edit);
+        lock_guard<mutex> lock(stateMutex);
         auto map_it = applicationMap.find(id);
         if (map_it == applicationMap.end()) {
             cout << "Aplikasi dengan ID '" << id << "' tidak ditemukan.\n";
-            return;
+            return false;
         }
         auto app_it = map_it->second;
         string oldName = app_it->name;
 
-        revisionStack[id].push_back(*app_it);
+        revisionStack.push(id, *app_it);
         
         if (oldName != newName) {
              bstRootByName = bstRemove(bstRootByName, oldName, app_it);
@@ -345,31 +966,40 @@ public:
         
         if (oldName != newName) {bstRootByName = bstInsert(bstRootByName, app_it);
         } else if (bstRootByName != nullptr && app_it->name == oldName) {}
+        dedupIndex.add(id, newName, newAddress, newRegion);
+        timeline.record(time(nullptr), ActivityType::Modified, id);
 
 
-        saveApplicationsToFile();
-        saveRevisionsToFile();
+        markDirty(id);
+        snapshotWriter->schedule();
         cout << "Aplikasi diperbarui. ID: " << id << " (Status: revision)\n";
+        size_t skipped = 0;
+        vector<DuplicateMatch> duplicates = dedupIndex.findMatches(newName, newAddress, newRegion, id, &skipped);
+        warnDuplicates(duplicates, skipped);
+        return true;
     }
 
-    void undoRevision(const string& id) {
-        if (revisionStack.find(id) == revisionStack.end() || revisionStack[id].empty()) {
+    // Mengembalikan false bila tidak ada revisi untuk dibatalkan
+    bool undoRevision(const string& id) {
+        KTP_TIMED(KtpMetric::Undo);
+        lock_guard<mutex> lock(stateMutex);
+        if (revisionStack.count(id) == 0) {
             cout << "Tidak ada revisi untuk dibatalkan.\n";
-            return;
+            return false;
         }
         auto map_it = applicationMap.find(id);
         if (map_it == applicationMap.end()) { 
             cout << "Aplikasi tidak ditemukan.\n";  
-            return; 
+            return false; 
         }
 
         auto app_it = map_it->second;
         string nameBeforeUndo = app_it->name;
 
-        Applicant lastRevision = revisionStack[id].back();
-        revisionStack[id].pop_back();
-        if (revisionStack[id].empty()) {
-            revisionStack.erase(id);
+        Applicant lastRevision;
+        if (!revisionStack.pop(id, lastRevision)) {
+            cout << "Revisi tidak dapat dibaca dari file spill.\n";
+            return false;
         }
         
         // Update BST jika nama berubah
@@ -382,25 +1012,277 @@ public:
         if (nameBeforeUndo != app_it->name) { // Jika nama berubah setelah undo
             bstRootByName = bstInsert(bstRootByName, app_it); // Masukkan kembali ke BST dengan nama yang sudah di-undo
         }
+        dedupIndex.add(id, app_it->name, app_it->address, app_it->region);
+        timeline.record(time(nullptr), ActivityType::Reverted, id);
 
-        saveApplicationsToFile();
-        saveRevisionsToFile();
+        markDirty(id);
+        snapshotWriter->schedule();
         cout << "Revisi dibatalkan untuk aplikasi '" << id << "'.\n";
+        return true;
+    }
+
+    // Impor massal dari file TSV/CSV (lihat ktp_import.h untuk format). Baris divalidasi paralel
+    // per potongan, ID diduplikasi terhadap applicationMap dan terhadap baris lain di file, lalu
+    // semua baris valid digabung sekaligus ke antrian, hash map dan BST, dan satu snapshot
+    // ditulis di akhir. Baris yang ditolak ditulis ke rejectPath (default <file>.rejected.tsv).
+    ImportSummary importApplications(const string& path, const string& rejectPath = "") {
+        KTP_TIMED(KtpMetric::Import);
+        auto start = chrono::steady_clock::now();
+        ImportSummary summary;
+        summary.rejectPath = rejectPath.empty() ? path + ".rejected.tsv" : rejectPath;
+        char delimiter = importDelimiterFor(path);
+        time_t now = time(nullptr);
+
+        ImportColumns columns;
+        bool firstChunk = true;
+        unordered_set<string> seenIds; // ID eksplisit dari file yang sudah diterima
+        vector<Applicant> accepted;
+        vector<ImportReject> rejects;
+
+        summary.opened = readLineChunks(path, 65536, [&](vector<string>& lines, size_t firstLine) {
+            size_t skip = 0;
+            if (firstChunk) {
+                firstChunk = false;
+                if (columns.readHeader(splitImportLine(lines[0], delimiter))) skip = 1;
+            }
+            vector<ImportedRow> rows(lines.size());
+            parallelRanges(lines.size() - skip, [&](size_t begin, size_t end) {
+                for (size_t i = begin + skip; i < end + skip; ++i) {
+                    rows[i] = parseImportRow(lines[i], delimiter, columns, now);
+                }
+            });
+
+            lock_guard<mutex> lock(stateMutex);
+            for (size_t i = skip; i < rows.size(); ++i) {
+                ImportedRow& row = rows[i];
+                if (row.blank) continue;
+                summary.rowsRead++;
+                if (row.error.empty() && !row.app.id.empty()) {
+                    if (applicationMap.count(row.app.id) > 0) {
+                        row.error = "ID sudah ada: " + row.app.id;
+                    } else if (!seenIds.insert(row.app.id).second) {
+                        row.error = "ID duplikat di dalam file: " + row.app.id;
+                    }
+                }
+                if (row.error.empty()) {
+                    accepted.push_back(move(row.app));
+                } else {
+                    rejects.push_back({firstLine + i, row.error, move(lines[i])});
+                }
+            }
+        });
+        if (!summary.opened) {
+            cout << "File impor '" << path << "' tidak bisa dibuka.\n";
+            return summary;
+        }
+
+        if (!accepted.empty()) {
+            lock_guard<mutex> lock(stateMutex);
+            applicationMap.reserve(applicationMap.size() + accepted.size());
+            vector<list<Applicant>::iterator> added;
+            vector<ActivityEvent> events;
+            added.reserve(accepted.size());
+            events.reserve(accepted.size());
+            unordered_map<string, int> nextSuffix; // Banyak baris tanpa ID bisa berbagi region + waktu yang sama
+            for (auto& app : accepted) {
+                if (app.id.empty()) {
+                    // Seperti generateId, tetapi berdasarkan waktu pengajuan baris tersebut
+                    string base = app.region + "-" + to_string(app.submissionTime);
+                    int& suffix = nextSuffix[base]; // 0 = belum dipakai, lalu 2, 3, ...
+                    app.id = suffix == 0 ? base : base + "-" + to_string(suffix);
+                    while (applicationMap.count(app.id) > 0 || seenIds.count(app.id) > 0) {
+                        suffix = suffix == 0 ? 2 : suffix + 1;
+                        app.id = base + "-" + to_string(suffix);
+                    }
+                    suffix = suffix == 0 ? 2 : suffix + 1;
+                }
+                applicationQueue.push_back(move(app));
+                auto it = prev(applicationQueue.end());
+                applicationMap[it->id] = it;
+                dedupIndex.add(it->id, it->name, it->address, it->region);
+                markDirty(it->id);
+                added.push_back(it);
+                events.push_back({it->submissionTime, ActivityType::Submitted, it->id});
+            }
+            bstMergeBulk(move(added));
+            timeline.recordBatch(move(events));
+        }
+        summary.accepted = accepted.size();
+        summary.rejected = rejects.size();
+        accepted.clear();
+        accepted.shrink_to_fit();
+
+        if (!rejects.empty()) {
+            ofstream rejectFile(summary.rejectPath);
+            rejectFile << "line\treason\trow\n";
+            for (const auto& reject : rejects) {
+                rejectFile << reject.lineNumber << '\t' << reject.reason << '\t' << reject.line << '\n';
+            }
+        }
+        if (summary.accepted > 0) {
+            saveData();
+        }
+
+        summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        ostringstream seconds; // Format lokal agar presisi/flag cout milik pemanggil tidak berubah
+        seconds << fixed << setprecision(2) << summary.seconds;
+        cout << "Impor selesai: " << summary.rowsRead << " baris dibaca, " << summary.accepted << " diterima, "
+             << summary.rejected << " ditolak dalam " << seconds.str() << " detik ("
+             << static_cast<size_t>(summary.seconds > 0 ? static_cast<double>(summary.rowsRead) / summary.seconds : 0.0)
+             << " baris/detik).\n";
+        if (summary.rejected > 0) {
+            cout << "Baris yang ditolak ditulis ke '" << summary.rejectPath << "'.\n";
+        }
+        return summary;
+    }
+
+    // --- Query tanpa output ke konsol (dipakai oleh mode server) ---
+
+    const Applicant* findApplication(const string& id) const {
+        auto map_it = applicationMap.find(id);
+        return map_it == applicationMap.end() ? nullptr : &*map_it->second;
+    }
+
+    size_t revisionCount(const string& id) const {
+        return revisionStack.count(id);
+    }
+
+    // Lama stateMutex ditahan oleh snapshot terakhir, dalam nanodetik
+    uint64_t snapshotLockNanos() const {
+        return lastSnapshotLockNanos;
+    }
+
+    // Perkiraan byte heap per struktur data (lihat ktp_memory.h untuk asumsi perhitungannya)
+    MemoryReport memoryReport() const {
+        lock_guard<mutex> lock(stateMutex);
+        MemoryReport report;
+        report.applications = applicationQueue.size();
+
+        size_t stringBytes = 0;
+        for (const auto& app : applicationQueue) {
+            stringBytes += ktpmem::stringHeapBytes(app.id) + ktpmem::stringHeapBytes(app.name) +
+                           ktpmem::stringHeapBytes(app.address) + ktpmem::stringHeapBytes(app.region) +
+                           ktpmem::stringHeapBytes(app.status);
+        }
+        report.structures.push_back({"applicationQueue (node list)", applicationQueue.size(),
+                                     applicationQueue.size() * ktpmem::allocationBytes(ktpmem::listNodeBytes<Applicant>())});
+        report.structures.push_back({"string aplikasi (heap, di luar SSO)", applicationQueue.size() * 5, stringBytes});
+
+        size_t mapBytes = ktpmem::hashTableBytes(applicationMap);
+        for (const auto& entry : applicationMap) mapBytes += ktpmem::stringHeapBytes(entry.first);
+        report.structures.push_back({"applicationMap (bucket + node + kunci)", applicationMap.size(), mapBytes});
+
+        vector<list<Applicant>::iterator> nodes;
+        bstInOrderTraversal(bstRootByName, nodes);
+        size_t bstBytes = nodes.size() * ktpmem::allocationBytes(sizeof(BstNode));
+#ifndef KTP_CAPACITY_MODE
+        for (auto it : nodes) bstBytes += ktpmem::stringHeapBytes(it->name); // Salinan keyName
+#endif
+        report.structures.push_back({"BST nama", nodes.size(), bstBytes});
+
+        report.structures.push_back({"revisionStack", revisionStack.size(), revisionStack.memoryBytes()});
+        report.structures.push_back({"timeline aktivitas", timeline.size(), timeline.memoryBytes()});
+        report.structures.push_back({"indeks pemohon ganda", dedupIndex.size(), dedupIndex.memoryBytes()});
+        report.spillFileBytes = revisionStack.spillBytes();
+        return report;
+    }
+
+    const list<Applicant>& applications() const {
+        return applicationQueue;
+    }
+
+    const ActivityTimeline& activity() const {
+        return timeline;
+    }
+
+    // Kemungkinan duplikat dari satu aplikasi yang sudah ada. skipped: lihat DedupIndex::findMatches.
+    vector<DuplicateMatch> findDuplicates(const string& id, size_t* skipped = nullptr) const {
+        lock_guard<mutex> lock(stateMutex);
+        if (skipped != nullptr) *skipped = 0;
+        auto map_it = applicationMap.find(id);
+        if (map_it == applicationMap.end()) return {};
+        const Applicant& app = *map_it->second;
+        return dedupIndex.findMatches(app.name, app.address, app.region, id, skipped);
+    }
+
+    // Semua cluster pemohon ganda. Indeks hanya dikunci saat disalin; pencarian berjalan paralel.
+    vector<vector<string>> duplicateClusters() const {
+        vector<DedupEntry> entries;
+        {
+            lock_guard<mutex> lock(stateMutex);
+            entries = dedupIndex.snapshot();
+        }
+        return findDuplicateClusters(entries);
+    }
+
+    // sortBy: "name" (via BST), "region" (region, waktu), "time", "status" (status, nama),
+    // atau "queue" (urutan FIFO saat ini)
+    vector<Applicant> listApplications(const string& sortBy = "queue") const {
+        return listApplications(sortBy, 0, numeric_limits<size_t>::max()).applications;
+    }
+
+    // Satu halaman hasil: hanya aplikasi ke-[offset, offset+limit) yang disalin. "queue" dan "name"
+    // menelusuri list/BST yang sudah terurut; urutan lain hanya mengurutkan pointer sampai akhir halaman.
+    ApplicationPage listApplications(const string& sortBy, size_t offset, size_t limit) const {
+        lock_guard<mutex> lock(stateMutex);
+        ApplicationPage page;
+        page.total = applicationQueue.size();
+        offset = min(offset, page.total);
+        limit = min(limit, page.total - offset);
+        page.applications.reserve(limit);
+        if (sortBy == "name") {
+            bstCopyWindow(bstRootByName, offset, limit, page.applications);
+            return page;
+        }
+        if (sortBy != "region" && sortBy != "time" && sortBy != "status") {
+            auto it = next(applicationQueue.begin(), static_cast<ptrdiff_t>(offset));
+            for (size_t i = 0; i < limit; ++i, ++it) {
+                page.applications.push_back(*it);
+            }
+            return page;
+        }
+        vector<const Applicant*> order;
+        order.reserve(applicationQueue.size());
+        for (const auto& app : applicationQueue) {
+            order.push_back(&app);
+        }
+        auto deref = [](const Applicant* app) -> const Applicant& { return *app; };
+        size_t end = offset + limit;
+        if (sortBy == "region") {
+            selectFirstByKeys<ktpsort::ByRegion, ktpsort::ByTime>(order, end, deref);
+        } else if (sortBy == "time") {
+            selectFirstByKeys<ktpsort::ByTime>(order, end, deref);
+        } else {
+            selectFirstByKeys<ktpsort::ByStatus, ktpsort::ByName>(order, end, deref);
+        }
+        for (size_t i = offset; i < end; ++i) {
+            page.applications.push_back(*order[i]);
+        }
+        return page;
+    }
+
+    // Menyimpan aplikasi dan revisi ke file dan menunggu sampai snapshot selesai ditulis
+    void saveData() {
+        snapshotWriter->schedule();
+        snapshotWriter->flush();
     }
 
     void sortByRegion() {
-        applicationQueue.sort([](const Applicant& a, const Applicant& b) { return a.region < b.region; });
-        rebuildMap();
+        KTP_TIMED(KtpMetric::Sort);
+        lock_guard<mutex> lock(stateMutex);
+        reorderQueue<ktpsort::ByRegion, ktpsort::ByTime>();
         cout << "Aplikasi diurutkan berdasarkan region.\n";
     }
 
     void sortByTime() {
-        applicationQueue.sort([](const Applicant& a, const Applicant& b) { return a.submissionTime < b.submissionTime; });
-        rebuildMap();
+        KTP_TIMED(KtpMetric::Sort);
+        lock_guard<mutex> lock(stateMutex);
+        reorderQueue<ktpsort::ByTime>();
         cout << "Aplikasi diurutkan berdasarkan waktu pengajuan.\n";
     }
 
     void displayQueue() {
+        KTP_TIMED(KtpMetric::Display);
         if (applicationQueue.empty()) { 
             cout << "Antrian kosong.\n";  
             return; 
@@ -416,6 +1298,7 @@ public:
     }
     
     void displayByBSTName() {
+        KTP_TIMED(KtpMetric::Display);
         if (bstRootByName == nullptr) {
             cout << "Tidak ada aplikasi untuk ditampilkan (BST kosong).\n";
             return;
@@ -432,11 +1315,361 @@ public:
                  << "\n   Region: " << app_iter->region << "\n   Status: " << app_iter->status << "\n   Diajukan: " << timeBuffer << "\n----------------------------------------\n";
         }
     }
+
+    void displayMemoryUsage() {
+        memoryReport().writeText(cout);
+#ifdef KTP_CAPACITY_MODE
+        cout << "  Mode kapasitas aktif: BST tanpa salinan nama, revisi di file spill.\n";
+#endif
+    }
+
+    void displayDuplicateClusters() {
+        KTP_TIMED(KtpMetric::Display);
+        vector<vector<string>> clusters = duplicateClusters();
+        if (clusters.empty()) {
+            cout << "Tidak ditemukan pemohon ganda.\n";
+            return;
+        }
+        cout << "\n--- Kemungkinan Pemohon Ganda --- (" << clusters.size() << " kelompok)\n";
+        int position = 1;
+        for (const auto& cluster : clusters) {
+            cout << position++ << ".";
+            for (const auto& id : cluster) {
+                auto map_it = applicationMap.find(id);
+                cout << "\n   " << id;
+                if (map_it != applicationMap.end()) {
+                    cout << " | " << map_it->second->name << " | " << map_it->second->address << " | " << map_it->second->region;
+                }
+            }
+            cout << "\n----------------------------------------\n";
+        }
+    }
+
+    // Menampilkan semua aktivitas pada satu tanggal (YYYY-MM-DD) beserta rekapnya
+    void displayDailyActivity(const string& day) {
+        KTP_TIMED(KtpMetric::Display);
+        time_t start, end;
+        if (!ActivityTimeline::dayRange(day, start, end)) {
+            cout << "Format tanggal tidak valid. Gunakan YYYY-MM-DD.\n";
+            return;
+        }
+        vector<ActivityEvent> events = timeline.between(start, end);
+        if (events.empty()) {
+            cout << "Tidak ada aktivitas pada " << day << ".\n";
+            return;
+        }
+        cout << "\n--- Aktivitas " << day << " --- (" << events.size() << " aktivitas)\n";
+        for (const auto& event : events) {
+            char timeBuffer[16];
+            strftime(timeBuffer, sizeof(timeBuffer), "%H:%M:%S", localtime(&event.time));
+            auto map_it = applicationMap.find(event.applicationId);
+            cout << timeBuffer << "  " << activityTypeName(event.type) << "  " << event.applicationId;
+            if (map_it != applicationMap.end()) {
+                cout << " (" << map_it->second->name << ")";
+            }
+            cout << "\n";
+        }
+        for (const auto& entry : timeline.rollups(day, day)) {
+            cout << "Rekap: diajukan " << entry.second.count(ActivityType::Submitted)
+                 << ", diverifikasi " << entry.second.count(ActivityType::Verified)
+                 << ", diubah " << entry.second.count(ActivityType::Modified)
+                 << ", dibatalkan " << entry.second.count(ActivityType::Reverted) << "\n";
+        }
+    }
 };
 
-int main() {
+// --- Mode server: API HTTP/JSON dengan bentuk yang sama seperti app/api/ktp ---
+
+string applicantToJson(const Applicant& app) {
+    return "{\"id\":\"" + jsonEscape(app.id) + "\",\"name\":\"" + jsonEscape(app.name) +
+           "\",\"address\":\"" + jsonEscape(app.address) + "\",\"region\":\"" + jsonEscape(app.region) +
+           "\",\"submission_time\":" + to_string(app.submissionTime) + ",\"status\":\"" + jsonEscape(app.status) + "\"}";
+}
+
+// "possible_duplicates" beserta "unchecked_candidates" (kandidat yang dilewati karena batas bucket)
+string duplicatesToJson(const vector<DuplicateMatch>& matches, size_t skipped) {
+    string out = "\"possible_duplicates\":[";
+    for (size_t i = 0; i < matches.size(); ++i) {
+        if (i > 0) out += ",";
+        out += "{\"id\":\"" + jsonEscape(matches[i].id) + "\",\"score\":" + to_string(matches[i].score) + "}";
+    }
+    return out + "],\"unchecked_candidates\":" + to_string(skipped);
+}
+
+// duplicates: bila diisi, ditambahkan sebagai "possible_duplicates" (respons submit/edit)
+HttpResponse applicationResponse(const Applicant* app, int status = 200, const vector<DuplicateMatch>* duplicates = nullptr,
+                                 size_t skipped = 0) {
+    if (app == nullptr) {
+        return {404, "application/json", jsonError("Application not found")};
+    }
+    string body = "{\"application\":" + applicantToJson(*app);
+    if (duplicates != nullptr) {
+        body += "," + duplicatesToJson(*duplicates, skipped);
+    }
+    return {status, "application/json", body + "}"};
+}
+
+// Membaca parameter query bilangan bulat tak bertanda (hanya digit, <= max). Parameter yang tidak ada
+// memberi fallback; nilai negatif ("-1" akan dibungkus stoull menjadi angka raksasa), bukan angka,
+// atau terlalu besar mengembalikan false.
+bool queryNumber(const HttpRequest& request, const string& key, size_t fallback, size_t& value,
+                 size_t max = numeric_limits<size_t>::max()) {
+    auto it = request.query.find(key);
+    if (it == request.query.end()) {
+        value = fallback;
+        return true;
+    }
+    const string& text = it->second;
+    if (text.empty() || !all_of(text.begin(), text.end(), [](unsigned char c) { return isdigit(c) != 0; })) {
+        return false;
+    }
+    try {
+        unsigned long long parsed = stoull(text);
+        if (parsed > max) return false;
+        value = static_cast<size_t>(parsed);
+        return true;
+    } catch (const std::exception&) {
+        return false; // Di luar jangkauan unsigned long long
+    }
+}
+
+// Membaca name/address/region dari body JSON; mengembalikan pesan error bila tidak valid
+string readApplicationBody(const HttpRequest& request, map<string, string>& fields) {
+    // parseFlatJson menolak karakter kontrol (termasuk \t, \n, \u0000) yang akan merusak file snapshot
+    if (!parseFlatJson(request.body, fields)) {
+        return "Invalid request body: expected a JSON object without control characters";
+    }
+    if (fields["name"].empty() || fields["address"].empty() || fields["region"].empty()) {
+        return "Name, address, and region are required";
+    }
+    return "";
+}
+
+HttpResponse handleApiRequest(KtpSystem& system, const HttpRequest& request) {
+    const string prefix = "/api/ktp";
+
+    if (request.path == prefix) {
+        if (request.method == "GET") {
+            auto sortIt = request.query.find("sort");
+            size_t offset = 0, limit = 0;
+            if (!queryNumber(request, "offset", 0, offset) ||
+                !queryNumber(request, "limit", numeric_limits<size_t>::max(), limit)) {
+                return {400, "application/json", jsonError("Invalid offset or limit, expected a non-negative integer")};
+            }
+            ApplicationPage page = system.listApplications(sortIt == request.query.end() ? "queue" : sortIt->second, offset, limit);
+            string body = "{\"total\":" + to_string(page.total) + ",\"applications\":[";
+            for (size_t i = 0; i < page.applications.size(); ++i) {
+                if (i > 0) body += ",";
+                body += applicantToJson(page.applications[i]);
+            }
+            return {200, "application/json", body + "]}"};
+        }
+        if (request.method == "POST") {
+            map<string, string> fields;
+            string error = readApplicationBody(request, fields);
+            if (!error.empty()) return {400, "application/json", jsonError(error)};
+            string id = system.submitApplication(fields["name"], fields["address"], fields["region"]);
+            size_t skipped = 0;
+            vector<DuplicateMatch> duplicates = system.findDuplicates(id, &skipped);
+            return applicationResponse(system.findApplication(id), 201, &duplicates, skipped);
+        }
+        return {405, "application/json", jsonError("Method not allowed")};
+    }
+
+    if (request.path.compare(0, prefix.size() + 1, prefix + "/") == 0) {
+        string id = request.path.substr(prefix.size() + 1);
+        if (request.method == "GET") {
+            return applicationResponse(system.findApplication(id));
+        }
+        if (request.method == "PUT") {
+            map<string, string> fields;
+            string error = readApplicationBody(request, fields);
+            if (!error.empty()) return {400, "application/json", jsonError(error)};
+            if (!system.editApplication(id, fields["name"], fields["address"], fields["region"])) {
+                return applicationResponse(nullptr);
+            }
+            size_t skipped = 0;
+            vector<DuplicateMatch> duplicates = system.findDuplicates(id, &skipped);
+            return applicationResponse(system.findApplication(id), 200, &duplicates, skipped);
+        }
+        if (request.method == "PATCH") {
+            map<string, string> fields;
+            if (!parseFlatJson(request.body, fields)) return {400, "application/json", jsonError("Invalid request body")};
+            const string& action = fields["action"];
+            if (action.empty()) return {400, "application/json", jsonError("Action is required")};
+            if (action == "verify") {
+                system.processVerification(id);
+                return applicationResponse(system.findApplication(id));
+            }
+            if (action == "undo") {
+                if (!system.undoRevision(id)) return {404, "application/json", jsonError("No revisions found")};
+                return applicationResponse(system.findApplication(id));
+            }
+            return {400, "application/json", jsonError("Invalid action")};
+        }
+        return {405, "application/json", jsonError("Method not allowed")};
+    }
+
+    if (request.path == "/api/stats" && request.method == "GET") {
+        map<string, size_t> byStatus, byRegion;
+        size_t revisions = 0;
+        for (const auto& app : system.applications()) {
+            byStatus[app.status]++;
+            byRegion[app.region]++;
+            revisions += system.revisionCount(app.id);
+        }
+        auto toJson = [](const map<string, size_t>& counts) {
+            string out = "{";
+            for (const auto& entry : counts) {
+                if (out.size() > 1) out += ",";
+                out += "\"" + jsonEscape(entry.first) + "\":" + to_string(entry.second);
+            }
+            return out + "}";
+        };
+        return {200, "application/json",
+                "{\"total\":" + to_string(system.applications().size()) + ",\"revisions\":" + to_string(revisions) +
+                ",\"by_status\":" + toJson(byStatus) + ",\"by_region\":" + toJson(byRegion) + "}"};
+    }
+
+    // Aktivitas dalam rentang waktu: ?from=&to= (detik Unix, to eksklusif) atau ?date=YYYY-MM-DD
+    if (request.path == "/api/activity" && request.method == "GET") {
+        time_t from = 0, to = numeric_limits<time_t>::max();
+        auto dateIt = request.query.find("date");
+        if (dateIt != request.query.end()) {
+            if (!ActivityTimeline::dayRange(dateIt->second, from, to)) {
+                return {400, "application/json", jsonError("Invalid date, expected YYYY-MM-DD")};
+            }
+        } else {
+            const size_t maxTime = static_cast<size_t>(numeric_limits<time_t>::max());
+            size_t fromValue = 0, toValue = 0;
+            if (!queryNumber(request, "from", 0, fromValue, maxTime) ||
+                !queryNumber(request, "to", maxTime, toValue, maxTime)) {
+                return {400, "application/json", jsonError("Invalid from or to, expected Unix seconds (non-negative integer)")};
+            }
+            from = static_cast<time_t>(fromValue);
+            to = static_cast<time_t>(toValue);
+        }
+        const ActivityTimeline& timeline = system.activity();
+        vector<ActivityEvent> events = timeline.between(from, to);
+
+        string body = "{\"activities\":[";
+        for (size_t i = 0; i < events.size(); ++i) {
+            if (i > 0) body += ",";
+            const Applicant* app = system.findApplication(events[i].applicationId);
+            body += "{\"activity_type\":\"" + string(activityTypeName(events[i].type)) + "\",\"activity_time\":" +
+                    to_string(events[i].time) + ",\"application_id\":\"" + jsonEscape(events[i].applicationId) +
+                    "\",\"application\":" + (app ? applicantToJson(*app) : string("null")) + "}";
+        }
+        body += "],\"days\":[";
+        if (!events.empty()) {
+            auto days = timeline.rollups(ActivityTimeline::dayKey(events.front().time), ActivityTimeline::dayKey(events.back().time));
+            for (size_t i = 0; i < days.size(); ++i) {
+                if (i > 0) body += ",";
+                body += "{\"date\":\"" + days[i].first + "\"";
+                for (int t = 0; t < static_cast<int>(ActivityType::Count); ++t) {
+                    body += ",\"" + string(activityTypeName(static_cast<ActivityType>(t))) + "\":" +
+                            to_string(days[i].second.count(static_cast<ActivityType>(t)));
+                }
+                body += "}";
+            }
+        }
+        return {200, "application/json", body + "]}"};
+    }
+
+    // Pemohon ganda: ?id= untuk satu aplikasi, tanpa parameter untuk semua cluster
+    if (request.path == "/api/duplicates" && request.method == "GET") {
+        auto idIt = request.query.find("id");
+        if (idIt != request.query.end()) {
+            if (system.findApplication(idIt->second) == nullptr) return applicationResponse(nullptr);
+            size_t skipped = 0;
+            vector<DuplicateMatch> duplicates = system.findDuplicates(idIt->second, &skipped);
+            return {200, "application/json", "{\"id\":\"" + jsonEscape(idIt->second) + "\"," +
+                    duplicatesToJson(duplicates, skipped) + "}"};
+        }
+        vector<vector<string>> clusters = system.duplicateClusters();
+        string body = "{\"total\":" + to_string(clusters.size()) + ",\"clusters\":[";
+        for (size_t i = 0; i < clusters.size(); ++i) {
+            if (i > 0) body += ",";
+            body += "[";
+            for (size_t j = 0; j < clusters[i].size(); ++j) {
+                if (j > 0) body += ",";
+                const Applicant* app = system.findApplication(clusters[i][j]);
+                body += app ? applicantToJson(*app) : "{\"id\":\"" + jsonEscape(clusters[i][j]) + "\"}";
+            }
+            body += "]";
+        }
+        return {200, "application/json", body + "]}"};
+    }
+
+    if (request.path == "/api/memory" && request.method == "GET") {
+        MemoryReport report = system.memoryReport();
+        string body = "{\"applications\":" + to_string(report.applications) + ",\"total_bytes\":" + to_string(report.total()) +
+                      ",\"bytes_per_application\":" + to_string(report.bytesPerApplication()) +
+                      ",\"spill_file_bytes\":" + to_string(report.spillFileBytes);
+#ifdef KTP_CAPACITY_MODE
+        body += ",\"capacity_mode\":true,\"structures\":[";
+#else
+        body += ",\"capacity_mode\":false,\"structures\":[";
+#endif
+        for (size_t i = 0; i < report.structures.size(); ++i) {
+            if (i > 0) body += ",";
+            body += "{\"name\":\"" + jsonEscape(report.structures[i].structure) + "\",\"items\":" +
+                    to_string(report.structures[i].items) + ",\"bytes\":" + to_string(report.structures[i].bytes) + "}";
+        }
+        return {200, "application/json", body + "]}"};
+    }
+
+    if (request.path == "/metrics" && request.method == "GET") {
+        ostringstream out;
+        metrics().writePrometheus(out);
+        return {200, "text/plain; version=0.0.4", out.str()};
+    }
+
+    return {404, "application/json", jsonError("Not found")};
+}
+
+// KTP_NO_MAIN memungkinkan file ini di-include oleh program lain (mis. ktp_benchmark.cpp)
+#ifndef KTP_NO_MAIN
+int main(int argc, char* argv[]) {
+    metrics().configureFromEnv();
+
+    // Mode server: ktp_system_bst_local --serve [port] [--host 127.0.0.1]
+    // Impor massal: ktp_system_bst_local --import file.csv|file.tsv [--rejects path]
+    bool serve = false;
+    string importPath, rejectPath;
+    int port = 8787;
+    string host = "127.0.0.1";
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--serve") {
+            serve = true;
+            if (i + 1 < argc && isdigit(static_cast<unsigned char>(argv[i + 1][0]))) port = atoi(argv[++i]);
+        } else if (arg == "--host" && i + 1 < argc) {
+            host = argv[++i];
+        } else if (arg == "--import" && i + 1 < argc) {
+            importPath = argv[++i];
+        } else if (arg == "--rejects" && i + 1 < argc) {
+            rejectPath = argv[++i];
+        }
+    }
+
     KtpSystem system;
 
+    if (!importPath.empty()) {
+        ImportSummary summary = system.importApplications(importPath, rejectPath);
+        return summary.opened ? 0 : 1;
+    }
+
+    if (serve) {
+        HttpServer server(host, port, [&system](const HttpRequest& request) {
+            return handleApiRequest(system, request);
+        });
+        if (const char* idle = getenv("KTP_SERVER_IDLE_SECONDS")) {
+            server.setIdleTimeout(chrono::seconds(max(1, atoi(idle))));
+        }
+        return server.run() ? 0 : 1;
+    }
+
     while (true) {
         cout << "\n=== Sistem Manajemen KTP ==="
              << "\n1. Ajukan Aplikasi Baru"
@@ -446,8 +1679,13 @@ int main() {
              << "\n5. Urutkan berdasarkan Region (Tampilan FIFO)"
              << "\n6. Urutkan berdasarkan Waktu Pengajuan (Tampilan FIFO)"
              << "\n7. Tampilkan Antrian (FIFO)"
-             << "\n8. Tampilkan Aplikasi Urut Nama (BST)" // Opsi Baru
-             << "\n9. Keluar"
+             << "\n8. Tampilkan Aplikasi Urut Nama (BST)"
+             << "\n9. Tampilkan Statistik Kinerja"
+             << "\n10. Tampilkan Aktivitas Harian"
+             << "\n11. Impor Aplikasi dari File (TSV/CSV)"
+             << "\n12. Cari Pemohon Ganda"
+             << "\n13. Tampilkan Pemakaian Memori"
+             << "\n0. Keluar"
              << "\nMasukkan pilihan: ";
 
         int choice;
@@ -460,7 +1698,7 @@ int main() {
         }
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
-        if (choice == 9) { cout << "Keluar dari sistem." << endl; break; }
+        if (choice == 0) { cout << "Keluar dari sistem." << endl; break; }
 
         string id, name, address, region;
 
@@ -494,9 +1732,33 @@ int main() {
             case 8: 
                 system.displayByBSTName(); 
                 break;
+            case 9:
+                metrics().dumpStats(cout);
+                break;
+            case 10: {
+                string day;
+                cout << "Tanggal (YYYY-MM-DD): ";
+                getline(cin, day);
+                system.displayDailyActivity(day);
+                break;
+            }
+            case 11: {
+                string path;
+                cout << "Path file (.tsv/.csv): ";
+                getline(cin, path);
+                system.importApplications(path);
+                break;
+            }
+            case 12:
+                system.displayDuplicateClusters();
+                break;
+            case 13:
+                system.displayMemoryUsage();
+                break;
             default: 
                 cout << "Pilihan tidak valid.\n";
         }
     }
     return 0;
 }
+#endif
@@ -0,0 +1,255 @@
+// Timeline aktivitas KtpSystem: setiap submit, verifikasi, edit dan undo dicatat dengan waktunya.
+//
+// - Event disimpan dalam vector yang terurut menurut waktu, sehingga query "aktivitas antara
+//   T1 dan T2" cukup dua binary search + k event: O(log n + k).
+// - Rekap per hari (bucket tanggal lokal YYYY-MM-DD) dipelihara saat event dicatat, sehingga
+//   rekap rentang tanggal juga O(log d + k).
+// - Event ditambahkan ke log append-only (data/ktp_events.txt) dan dibaca ulang saat startup.
+//   record() hanya menambah baris ke buffer di memori; pemilik timeline mengambilnya dengan
+//   takePendingLog() dan menulisnya dengan appendToLog() di luar lock (KtpSystem melakukannya
+//   dari thread SnapshotWriter), sehingga tidak ada I/O per event di jalur mutasi.
+#ifndef KTP_TIMELINE_H
+#define KTP_TIMELINE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ktp_memory.h"
+
+enum class ActivityType { Submitted, Verified, Modified, Reverted, Count };
+
+inline const char* activityTypeName(ActivityType type) {
+    switch (type) {
+        case ActivityType::Submitted: return "submitted";
+        case ActivityType::Verified: return "verified";
+        case ActivityType::Modified: return "modified";
+        case ActivityType::Reverted: return "reverted";
+        default: return "unknown";
+    }
+}
+
+inline bool parseActivityType(const std::string& name, ActivityType& type) {
+    for (int i = 0; i < static_cast<int>(ActivityType::Count); ++i) {
+        if (name == activityTypeName(static_cast<ActivityType>(i))) {
+            type = static_cast<ActivityType>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+struct ActivityEvent {
+    time_t time;
+    ActivityType type;
+    std::string applicationId;
+};
+
+struct DailyRollup {
+    size_t counts[static_cast<int>(ActivityType::Count)] = {};
+
+    size_t count(ActivityType type) const { return counts[static_cast<int>(type)]; }
+};
+
+class ActivityTimeline {
+public:
+    // Tanggal lokal (YYYY-MM-DD) dari sebuah waktu; urutan leksikografis = urutan kronologis
+    static std::string dayKey(time_t time) {
+        char buffer[16];
+        strftime(buffer, sizeof(buffer), "%Y-%m-%d", localtime(&time));
+        return buffer;
+    }
+
+    // Membaca log event. Mengembalikan false bila log belum ada.
+    bool load(const std::string& path) {
+        logPath = path;
+        events.clear();
+        daily.clear();
+        pendingLog.clear();
+        cachedRollup = nullptr;
+        std::ifstream file(path);
+        if (!file.is_open()) return false;
+
+        std::string line;
+        while (std::getline(file, line)) {
+            std::istringstream ss(line);
+            std::string timeText, typeText, id;
+            if (!std::getline(ss, timeText, '\t') || !std::getline(ss, typeText, '\t') || !std::getline(ss, id)) {
+                continue;
+            }
+            ActivityEvent event;
+            if (!parseActivityType(typeText, event.type)) continue;
+            try {
+                event.time = static_cast<time_t>(std::stoll(timeText));
+            } catch (const std::exception&) {
+                continue;
+            }
+            event.applicationId = id;
+            insert(event);
+        }
+        return true;
+    }
+
+    // Mencatat event ke memori; barisnya menunggu di buffer log sampai appendToLog()
+    void record(time_t time, ActivityType type, const std::string& applicationId) {
+        ActivityEvent event{time, type, applicationId};
+        insert(event);
+        appendLine(event);
+    }
+
+    // Mencatat banyak event sekaligus (mis. impor massal): satu merge, bukan satu insert per event
+    void recordBatch(std::vector<ActivityEvent> batch) {
+        if (batch.empty()) return;
+        std::stable_sort(batch.begin(), batch.end(),
+                         [](const ActivityEvent& a, const ActivityEvent& b) { return a.time < b.time; });
+        std::ptrdiff_t middle = static_cast<std::ptrdiff_t>(events.size());
+        events.insert(events.end(), batch.begin(), batch.end());
+        std::inplace_merge(events.begin(), events.begin() + middle, events.end(),
+                           [](const ActivityEvent& a, const ActivityEvent& b) { return a.time < b.time; });
+        for (const auto& event : batch) {
+            rollupFor(event.time).counts[static_cast<int>(event.type)]++;
+            appendLine(event);
+        }
+    }
+
+    // Mengambil baris log yang belum ditulis. Dipanggil di bawah lock yang sama dengan record().
+    std::string takePendingLog() {
+        std::string lines;
+        lines.swap(pendingLog);
+        return lines;
+    }
+
+    // Menambahkan baris dari takePendingLog() ke file log dengan satu write + flush. Tidak
+    // menyentuh state event, jadi boleh dipanggil tanpa lock asalkan hanya dari satu thread.
+    void appendToLog(const std::string& lines) {
+        if (lines.empty() || logPath.empty()) return;
+        if (!logFile.is_open()) {
+            logFile.open(logPath, std::ios::app);
+        }
+        if (logFile.is_open()) {
+            logFile.write(lines.data(), static_cast<std::streamsize>(lines.size()));
+            logFile.flush();
+        }
+    }
+
+    // Mengisi timeline dari data yang sudah ada (mis. saat log belum pernah dibuat) dan
+    // menulis ulang log sekaligus, bukan satu flush per event
+    void backfill(std::vector<ActivityEvent> initial) {
+        std::stable_sort(initial.begin(), initial.end(),
+                         [](const ActivityEvent& a, const ActivityEvent& b) { return a.time < b.time; });
+        events.clear();
+        daily.clear();
+        pendingLog.clear();
+        cachedRollup = nullptr;
+        for (const auto& event : initial) {
+            insert(event);
+        }
+        if (logPath.empty()) return;
+        logFile.close();
+        std::ofstream file(logPath, std::ios::trunc);
+        for (const auto& event : events) {
+            file << event.time << '\t' << activityTypeName(event.type) << '\t' << event.applicationId << '\n';
+        }
+    }
+
+    size_t size() const { return events.size(); }
+
+    // Perkiraan byte heap: vector event beserta ID-nya dan node map rekap harian
+    size_t memoryBytes() const {
+        size_t bytes = ktpmem::vectorBytes(events) + ktpmem::stringHeapBytes(pendingLog);
+        for (const auto& event : events) {
+            bytes += ktpmem::stringHeapBytes(event.applicationId);
+        }
+        // Node std::map: nilai + 3 pointer + warna
+        bytes += daily.size() * ktpmem::allocationBytes(sizeof(std::pair<const std::string, DailyRollup>) + 4 * sizeof(void*));
+        return bytes;
+    }
+
+    // Event dengan from <= waktu < to, terurut menurut waktu
+    std::vector<ActivityEvent> between(time_t from, time_t to) const {
+        auto first = std::lower_bound(events.begin(), events.end(), from,
+                                      [](const ActivityEvent& e, time_t t) { return e.time < t; });
+        auto last = std::lower_bound(first, events.end(), to,
+                                     [](const ActivityEvent& e, time_t t) { return e.time < t; });
+        return std::vector<ActivityEvent>(first, last);
+    }
+
+    // Rekap per hari untuk tanggal fromDay..toDay (inklusif, format YYYY-MM-DD)
+    std::vector<std::pair<std::string, DailyRollup>> rollups(const std::string& fromDay, const std::string& toDay) const {
+        std::vector<std::pair<std::string, DailyRollup>> result;
+        for (auto it = daily.lower_bound(fromDay); it != daily.end() && it->first <= toDay; ++it) {
+            result.push_back(*it);
+        }
+        return result;
+    }
+
+    // Awal dan akhir (eksklusif) hari lokal dari tanggal YYYY-MM-DD. Mengembalikan false bila format salah.
+    static bool dayRange(const std::string& day, time_t& start, time_t& end) {
+        std::tm tm = {};
+        std::istringstream ss(day);
+        char dash1 = 0, dash2 = 0;
+        ss >> tm.tm_year >> dash1 >> tm.tm_mon >> dash2 >> tm.tm_mday;
+        if (ss.fail() || dash1 != '-' || dash2 != '-') return false;
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+        tm.tm_isdst = -1;
+        start = mktime(&tm);
+        tm.tm_mday += 1;
+        tm.tm_isdst = -1;
+        end = mktime(&tm);
+        return start != static_cast<time_t>(-1) && end != static_cast<time_t>(-1);
+    }
+
+private:
+    std::vector<ActivityEvent> events; // Terurut menurut waktu
+    std::map<std::string, DailyRollup> daily;
+    std::string logPath;
+    std::ofstream logFile;
+    std::string pendingLog; // Baris log yang belum ditulis ke logFile
+    DailyRollup* cachedRollup = nullptr;
+    time_t cachedDayStart = 0;
+    time_t cachedDayEnd = 0;
+
+    void appendLine(const ActivityEvent& event) {
+        if (logPath.empty()) return;
+        pendingLog += std::to_string(static_cast<long long>(event.time));
+        pendingLog += '\t';
+        pendingLog += activityTypeName(event.type);
+        pendingLog += '\t';
+        pendingLog += event.applicationId;
+        pendingLog += '\n';
+    }
+
+    void insert(const ActivityEvent& event) {
+        // Event hampir selalu datang berurutan, jadi biasanya ini push_back biasa
+        if (events.empty() || events.back().time <= event.time) {
+            events.push_back(event);
+        } else {
+            auto pos = std::upper_bound(events.begin(), events.end(), event.time,
+                                        [](time_t t, const ActivityEvent& e) { return t < e.time; });
+            events.insert(pos, event);
+        }
+        rollupFor(event.time).counts[static_cast<int>(event.type)]++;
+    }
+
+    // Bucket harian untuk sebuah waktu. Bucket terakhir di-cache karena event yang berurutan
+    // hampir selalu jatuh di hari yang sama, sehingga localtime() dan pencarian map bisa dilewati.
+    DailyRollup& rollupFor(time_t time) {
+        if (cachedRollup == nullptr || time < cachedDayStart || time >= cachedDayEnd) {
+            std::string key = dayKey(time);
+            cachedRollup = &daily[key];
+            if (!dayRange(key, cachedDayStart, cachedDayEnd)) {
+                cachedDayStart = cachedDayEnd = time; // Cache tidak dipakai untuk waktu ini
+            }
+        }
+        return *cachedRollup;
+    }
+};
+
+#endif // KTP_TIMELINE_H
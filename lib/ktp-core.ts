@@ -0,0 +1,27 @@
+import { type NextRequest, NextResponse } from "next/server"
+
+// Base URL of the C++ KtpSystem server (`ktp_system_bst_local --serve`), e.g. http://127.0.0.1:8787
+// When unset, the API routes keep using Supabase directly.
+export const ktpCoreUrl = process.env.KTP_CORE_URL
+
+// Forward an API request to the C++ core and relay its JSON response
+export async function proxyToCore(request: NextRequest, path: string): Promise<NextResponse> {
+  const url = new URL(path, ktpCoreUrl)
+  url.search = request.nextUrl.search
+
+  try {
+    const body = request.method === "GET" || request.method === "HEAD" ? undefined : await request.text()
+    const response = await fetch(url, {
+      method: request.method,
+      headers: { "Content-Type": "application/json" },
+      body,
+      cache: "no-store",
+    })
+    return new NextResponse(await response.text(), {
+      status: response.status,
+      headers: { "Content-Type": response.headers.get("Content-Type") ?? "application/json" },
+    })
+  } catch (error) {
+    return NextResponse.json({ error: "KTP core server unavailable" }, { status: 502 })
+  }
+}
@@ -0,0 +1,171 @@
+// End-to-end check of ktp_system_bst against the stub backend
+//
+// Usage: node scripts/stub/check_remote_client.js [path to ktp_system_bst]
+//
+// Runs the client in a scratch directory with KTP_STUB_DELAY_MS (default 400) of backend latency
+// and drives the menu through stdin. Checks that submit/verify/edit return to the menu well before
+// one backend round trip, that a rejected command is reported from its JSON status line, and that
+// the stub database holds every change once the client has exited. The stub drops the response of
+// every batch that runs new commands (KTP_STUB_LOSE_RESPONSES), so each command is resent and must
+// still be applied exactly once, and a refresh in the meantime keeps the unconfirmed changes without
+// waiting for the queue. A second run repeats this without the command log
+// (KTP_STUB_NO_COMMAND_LOG): the client must report the degraded batches and must not resend
+// submit/edit, so each is still applied once. Exits non-zero on failure.
+const { spawn } = require("child_process")
+const fs = require("fs")
+const os = require("os")
+const path = require("path")
+
+const binary = path.resolve(process.argv[2] || "cpp/output/ktp_system_bst")
+const delayMs = Number.parseInt(process.env.KTP_STUB_DELAY_MS || "400", 10)
+const prompt = "Masukkan pilihan: "
+
+const failures = []
+function check(condition, message) {
+  console.log(`${condition ? "ok  " : "FAIL"} ${message}`)
+  if (!condition) failures.push(message)
+}
+
+// Starts the client in a fresh scratch directory and returns helpers to drive its menu
+function startClient(extraEnv = {}) {
+  const workDir = fs.mkdtempSync(path.join(os.tmpdir(), "ktp-remote-check-"))
+  fs.mkdirSync(path.join(workDir, "data"))
+  const child = spawn(binary, [], {
+    cwd: workDir,
+    env: {
+      ...process.env,
+      KTP_BACKEND_SCRIPTS: __dirname,
+      KTP_STUB_DELAY_MS: String(delayMs),
+      KTP_STUB_FAIL_RATE: "0",
+      KTP_STUB_LOSE_RESPONSES: "1",
+      KTP_CACHE_TTL: "3600",
+      ...extraEnv,
+    },
+    stdio: ["pipe", "pipe", "inherit"],
+  })
+
+  const client = { workDir, child, output: "" }
+  let waiter = null
+  child.stdout.on("data", (chunk) => {
+    client.output += chunk.toString()
+    if (waiter && client.output.split(prompt).length - 1 >= waiter.count) {
+      const resolve = waiter.resolve
+      waiter = null
+      resolve()
+    }
+  })
+
+  // Resolves once the menu prompt has been printed `count` times in total
+  client.waitForPrompt = (count) => {
+    if (client.output.split(prompt).length - 1 >= count) return Promise.resolve()
+    return new Promise((resolve) => (waiter = { count, resolve }))
+  }
+
+  let prompts = 1
+  client.step = async (input) => {
+    const started = Date.now()
+    child.stdin.write(input.join("\n") + "\n")
+    prompts++
+    await client.waitForPrompt(prompts)
+    return Date.now() - started
+  }
+
+  // Exits through the menu and returns the exit code and the stub database
+  client.exit = async () => {
+    child.stdin.write("0\n")
+    const code = await new Promise((resolve) => child.on("exit", resolve))
+    const db = JSON.parse(fs.readFileSync(path.join(workDir, "data", "ktp_stub_db.json"), "utf8"))
+    return { code, db }
+  }
+
+  client.ids = () => [...client.output.matchAll(/Aplikasi diajukan\. ID: (\S+)/g)].map((match) => match[1])
+  return client
+}
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms))
+
+async function main() {
+  const clients = []
+  const timeout = setTimeout(() => {
+    console.error("Timed out waiting for the client")
+    clients.forEach((client) => client.child.kill())
+    process.exit(1)
+  }, 60000 + 40 * delayMs)
+
+  const client = startClient()
+  clients.push(client)
+  const { step } = client
+  await client.waitForPrompt(1)
+  const names = ["Budi Santoso", "Siti Aminah", "Agus Salim"]
+  let slowest = 0
+  for (const name of names) {
+    slowest = Math.max(slowest, await step(["1", name, "Jl. Merdeka 1", "Bandung"]))
+  }
+  const ids = client.ids()
+  check(ids.length === names.length, `client assigned ${names.length} IDs (${ids.join(", ")})`)
+
+  slowest = Math.max(slowest, await step(["2", ids[0]]))
+  slowest = Math.max(slowest, await step(["3", ids[1], "Siti Aminah Putri", "Jl. Asia Afrika 2", "Bandung"]))
+  // Edit then undo on the same ID: the undo must run after the edit and only once
+  slowest = Math.max(slowest, await step(["3", ids[2], "Agus Salim Jr", "Jl. Braga 3", "Bandung"]))
+  slowest = Math.max(slowest, await step(["4", ids[2]]))
+  check(slowest < delayMs / 2, `mutations return to the menu without waiting for the backend (slowest ${slowest} ms, delay ${delayMs} ms)`)
+
+  // Refresh while those commands are still queued: the reload must not wait for the queue and the
+  // unconfirmed changes (including the undo of this session's edit) must survive it
+  const beforeRefresh = client.output.length
+  await step(["8"])
+  await step(["5"])
+  const refreshed = client.output.slice(beforeRefresh)
+  check(!refreshed.includes("Menunggu"), "refresh does not wait for the remote queue")
+  check(
+    /belum dikonfirmasi server diterapkan ulang/.test(refreshed) && refreshed.includes("Nama: Siti Aminah Putri") &&
+      refreshed.includes("Nama: Agus Salim\n") && !refreshed.includes("Agus Salim Jr"),
+    "pending edits and the undo are re-applied on top of the refreshed data",
+  )
+
+  // Rejected by the stub; the failure comes back as {"status":"error"} and is printed above the next menu
+  await step(["2", "TIDAK-ADA-1"])
+  await sleep(4 * delayMs + 500)
+  await step(["99"])
+  check(/\[Server\] Verifikasi TIDAK-ADA-1 gagal: .*not found/.test(client.output), "rejected verify is reported from its status line")
+
+  const { code, db } = await client.exit()
+  check(code === 0, `client exited cleanly (code ${code})`)
+
+  const byId = new Map(db.applications.map((app) => [app.id, app]))
+  check(ids.every((id) => byId.has(id)), "every submitted application reached the backend")
+  check(byId.get(ids[0])?.status === "verified", "verify was applied")
+  check(byId.get(ids[1])?.name === "Siti Aminah Putri" && byId.get(ids[1])?.status === "revision", "edit was applied")
+  check(byId.get(ids[2])?.name === "Agus Salim" && byId.get(ids[2])?.status === "pending", "undo restored the edited application")
+  check(db.revisions.length === 1, `resent edits and undos were applied once (${db.revisions.length} revision left)`)
+  const leftovers = fs.readdirSync(path.join(client.workDir, "data")).filter((file) => /^ktp_(command|response)_/.test(file))
+  check(leftovers.length === 0, "batch command/response files were cleaned up")
+  fs.rmSync(client.workDir, { recursive: true, force: true })
+
+  // Without the command log a resent command would run again, so lost responses become failures
+  const degraded = startClient({ KTP_STUB_NO_COMMAND_LOG: "1" })
+  clients.push(degraded)
+  await degraded.waitForPrompt(1)
+  await degraded.step(["1", "Dewi Lestari", "Jl. Dago 4", "Bandung"])
+  const [degradedId] = degraded.ids()
+  await degraded.step(["3", degradedId, "Dewi Lestari Putri", "Jl. Dago 5", "Bandung"])
+  await sleep(4 * delayMs + 500)
+  await degraded.step(["99"])
+  check(/\[Server\] Peringatan: Command log unavailable/.test(degraded.output), "degraded batch is reported to the user")
+  check(/\[Server\] Edit \S+ gagal: tidak diulang/.test(degraded.output), "edit with a lost response is reported instead of resent")
+  const degradedResult = await degraded.exit()
+  clearTimeout(timeout)
+  check(degradedResult.code === 0, `degraded client exited cleanly (code ${degradedResult.code})`)
+  const degradedApps = degradedResult.db.applications.filter((app) => app.id === degradedId)
+  check(degradedApps.length === 1 && degradedApps[0].name === "Dewi Lestari Putri", "degraded submit and edit reached the backend")
+  check(degradedResult.db.revisions.length === 1, `degraded edit was applied once (${degradedResult.db.revisions.length} revisions)`)
+  fs.rmSync(degraded.workDir, { recursive: true, force: true })
+  console.log(failures.length === 0 ? "All checks passed." : `${failures.length} check(s) failed.`)
+  process.exit(failures.length === 0 ? 0 : 1)
+}
+
+main().catch((error) => {
+  console.error(error)
+  process.exit(1)
+})
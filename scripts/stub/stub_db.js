@@ -0,0 +1,59 @@
+// Local stand-in for Supabase used to exercise the C++ client without network access.
+// State lives in data/ktp_stub_db.json; set KTP_STUB_DELAY_MS to simulate a slow backend.
+//
+// Usage: KTP_BACKEND_SCRIPTS=scripts/stub ./cpp/output/ktp_system_bst
+
+const fs = require("fs")
+const path = require("path")
+
+const dataDir = path.join(process.cwd(), "data")
+const dbFilePath = path.join(dataDir, "ktp_stub_db.json")
+const commandFilePath = path.join(dataDir, "ktp_command.txt")
+const responseFilePath = path.join(dataDir, "ktp_response.txt")
+const applicationsFilePath = path.join(dataDir, "ktp_applications_sync.txt")
+
+if (!fs.existsSync(dataDir)) {
+  fs.mkdirSync(dataDir, { recursive: true })
+}
+
+// Block for the configured delay, like a slow network round trip
+function simulateLatency() {
+  const delay = Number.parseInt(process.env.KTP_STUB_DELAY_MS || "0", 10)
+  if (delay > 0) {
+    Atomics.wait(new Int32Array(new SharedArrayBuffer(4)), 0, 0, delay)
+  }
+}
+
+function loadDb() {
+  if (!fs.existsSync(dbFilePath)) {
+    return { applications: [], revisions: [] }
+  }
+  return JSON.parse(fs.readFileSync(dbFilePath, "utf8"))
+}
+
+function saveDb(db) {
+  fs.writeFileSync(dbFilePath, JSON.stringify(db, null, 2))
+}
+
+function writeResponse(message) {
+  fs.writeFileSync(responseFilePath, message)
+  console.log(message)
+}
+
+function writeApplicationsToFile(db) {
+  const sorted = [...db.applications].sort((a, b) => a.submission_time - b.submission_time)
+  const fileContent = sorted
+    .map((app) => `${app.id}|${app.name}|${app.address}|${app.region}|${app.submission_time}|${app.status}\n`)
+    .join("")
+  fs.writeFileSync(applicationsFilePath, fileContent)
+  writeResponse(`Successfully synced ${sorted.length} applications from Supabase.`)
+}
+
+module.exports = {
+  commandFilePath,
+  loadDb,
+  saveDb,
+  simulateLatency,
+  writeApplicationsToFile,
+  writeResponse,
+}
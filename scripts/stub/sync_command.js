@@ -0,0 +1,154 @@
+// Stub for scripts/sync_command.js: applies commands to the stub database
+//
+// Legacy mode:  node sync_command.js                 (reads data/ktp_command.txt)
+// Batch mode:   node sync_command.js <command file> <response file>
+//   The whole batch is applied with one database load and save. Set KTP_STUB_FAIL_RATE (0..1)
+//   to make a batch fail without a response, like a dropped connection. With
+//   KTP_STUB_LOSE_RESPONSES=1 every batch that runs new commands is applied and saved but its
+//   response is dropped, so the client has to resend it and gets the recorded results.
+//   KTP_STUB_NO_COMMAND_LOG=1 acts as if ktp_command_log is missing: results are not recorded and
+//   the response file starts with {"batch":"degraded",...} (kept even when the rest is dropped).
+const fs = require("fs")
+const { commandFilePath, loadDb, saveDb, simulateLatency, writeApplicationsToFile, writeResponse } = require("./stub_db")
+
+function handleSubmit(db, data) {
+  const parts = data.split("|")
+  if (parts.length < 6) {
+    return { ok: false, message: "Invalid submit data format." }
+  }
+  const [id, name, address, region, submissionTimeStr, status] = parts
+  if (db.applications.some((app) => app.id === id)) {
+    return { ok: false, message: `Error submitting application: duplicate id ${id}` }
+  }
+  db.applications.push({ id, name, address, region, submission_time: Number.parseInt(submissionTimeStr, 10), status })
+  return { ok: true, message: `Application submitted successfully. ID: ${id}` }
+}
+
+function handleVerify(db, id) {
+  const app = db.applications.find((candidate) => candidate.id === id)
+  if (!app) return { ok: false, message: `Error: application ${id} not found` }
+  app.status = "verified"
+  return { ok: true, message: `Application ${id} has been verified.` }
+}
+
+function handleEdit(db, data) {
+  const parts = data.split("|")
+  if (parts.length < 4) {
+    return { ok: false, message: "Invalid edit data format." }
+  }
+  const [id, newName, newAddress, newRegion] = parts
+  const app = db.applications.find((candidate) => candidate.id === id)
+  if (!app) return { ok: false, message: `Error: application ${id} not found` }
+  db.revisions.push({ application_id: id, ...app, id: undefined, revision_time: Date.now() })
+  Object.assign(app, { name: newName, address: newAddress, region: newRegion, status: "revision" })
+  return { ok: true, message: `Application updated. ID: ${id}` }
+}
+
+function handleUndo(db, id) {
+  const index = db.revisions.map((revision) => revision.application_id).lastIndexOf(id)
+  if (index < 0) {
+    return { ok: false, message: `No revisions found for application ${id}` }
+  }
+  const app = db.applications.find((candidate) => candidate.id === id)
+  if (!app) return { ok: false, message: `Error: application ${id} not found` }
+  const [revision] = db.revisions.splice(index, 1)
+  Object.assign(app, { name: revision.name, address: revision.address, region: revision.region, status: revision.status })
+  return { ok: true, message: `Revision undone for application ${id}` }
+}
+
+const handlers = { submit: handleSubmit, verify: handleVerify, edit: handleEdit, undo: handleUndo }
+
+function runCommand(db, command, data) {
+  const handler = handlers[command]
+  if (!handler) return { ok: false, message: `Unknown command: ${command}` }
+  return handler(db, data)
+}
+
+// Results are kept for a day under "<session>:<correlation id>", like ktp_command_log
+const COMMAND_LOG_TTL_MS = 24 * 60 * 60 * 1000
+
+// Batch lines are "<correlation id>|<command>|<data>"; each result is one JSON line
+// {"id":"<correlation id>","status":"ok"|"error","message":...}. A command whose result is already
+// in db.commandLog is not run again.
+function processBatch(batchFilePath, batchResponsePath) {
+  const failRate = Number.parseFloat(process.env.KTP_STUB_FAIL_RATE || "0")
+  if (failRate > 0 && Math.random() < failRate) {
+    console.error("Simulated connection failure")
+    process.exit(1)
+  }
+
+  const lines = fs.readFileSync(batchFilePath, "utf8").split("\n").map((line) => line.trim())
+  const resync = !lines.includes("no-resync")
+  const session = lines.find((line) => line.startsWith("session "))?.slice("session ".length)
+  const noLog = process.env.KTP_STUB_NO_COMMAND_LOG === "1"
+  const header = noLog ? JSON.stringify({ batch: "degraded", message: "Command log unavailable (stub)" }) + "\n" : ""
+  fs.writeFileSync(batchResponsePath, header)
+  const db = loadDb()
+  const log = noLog ? {} : db.commandLog || {}
+  const now = Date.now()
+  const results = []
+  let changed = false
+  let ran = false
+  for (const line of lines.slice(1)) {
+    if (!line || line === "no-resync" || line.startsWith("session ")) continue
+    const [correlationId, command, ...rest] = line.split("|")
+    const key = session ? `${session}:${correlationId}` : null
+    let result = key ? log[key] : undefined
+    if (!result) {
+      const outcome = runCommand(db, command, rest.join("|"))
+      result = { status: outcome.ok ? "ok" : "error", message: outcome.message, time: now }
+      if (key) log[key] = result
+      changed = changed || outcome.ok
+      ran = true
+    }
+    results.push(JSON.stringify({ id: correlationId, status: result.status, message: result.message }))
+  }
+  if (ran) {
+    for (const [key, entry] of Object.entries(log)) {
+      if (now - entry.time > COMMAND_LOG_TTL_MS) delete log[key]
+    }
+    if (!noLog) db.commandLog = log
+    saveDb(db)
+    if (changed && resync) writeApplicationsToFile(db)
+    if (process.env.KTP_STUB_LOSE_RESPONSES === "1") {
+      console.error("Simulated lost response")
+      process.exit(1)
+    }
+  }
+  fs.writeFileSync(batchResponsePath, header + results.join("\n") + "\n")
+  console.log(`Processed ${results.length} commands.`)
+}
+
+function main() {
+  simulateLatency()
+  const [batchFilePath, batchResponsePath] = process.argv.slice(2)
+  if (batchFilePath && batchResponsePath) {
+    processBatch(batchFilePath, batchResponsePath)
+    return
+  }
+
+  if (!fs.existsSync(commandFilePath)) {
+    writeResponse("Command file not found.")
+    return
+  }
+  const lines = fs.readFileSync(commandFilePath, "utf8").split("\n")
+  const command = lines[0]?.trim()
+  const data = lines[1]?.trim()
+  const resync = lines[2]?.trim() !== "no-resync"
+  if (!command || !data) {
+    writeResponse("Invalid command file format.")
+    return
+  }
+
+  const db = loadDb()
+  const result = runCommand(db, command, data)
+  writeResponse(result.message)
+  if (result.ok) {
+    saveDb(db)
+    if (resync) {
+      writeApplicationsToFile(db)
+    }
+  }
+}
+
+main()
@@ -0,0 +1,5 @@
+// Stub for scripts/sync_data.js: writes the stub database to the sync file
+const { loadDb, simulateLatency, writeApplicationsToFile } = require("./stub_db")
+
+simulateLatency()
+writeApplicationsToFile(loadDb())
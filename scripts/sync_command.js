@@ -39,6 +39,16 @@ function writeResponse(message) {
   console.log(message)
 }
 
+// When the C++ client sends "no-resync" it applies the change to its own cache,
+// so the full table download after each command can be skipped.
+let resyncAfterCommand = true
+
+async function resyncApplications() {
+  if (resyncAfterCommand) {
+    await writeApplicationsToFile()
+  }
+}
+
 // Helper function to write all applications to a sync file
 async function writeApplicationsToFile() {
   try {
@@ -62,136 +72,347 @@ async function writeApplicationsToFile() {
   }
 }
 
-// Handle submit command
-async function handleSubmit(data) {
-  try {
-    const parts = data.split("|")
-    if (parts.length < 6) {
-      writeResponse("Invalid submit data format.")
-      return
-    }
-
-    const [id, name, address, region, submissionTimeStr, status] = parts
-    const submissionTime = parseInt(submissionTimeStr, 10)
+// Command helpers take a list of entries and return one { status, message } per entry, so the
+// batch mode can send consecutive commands as one bulk request. status is "ok", "error"
+// (permanent, e.g. a constraint violation) or "retry" (transient, e.g. the request never
+// reached Supabase).
+const ok = (message) => ({ status: "ok", message })
+
+// PostgREST errors carry a code; network/fetch errors do not. Those are only worth retrying when
+// re-sending the request is harmless (reads, updates to fixed values, inserts that are checked on
+// conflict). If a non-idempotent write (a revision insert or delete) may or may not have landed,
+// the command fails permanently so the client reloads instead of applying it twice.
+function failure(error, prefix, retryable = true) {
+  const message = `${prefix}: ${error.message}`.replace(/\s+/g, " ")
+  return { status: error?.code || !retryable ? "error" : "retry", message }
+}
 
-    if (isNaN(submissionTime)) {
-      writeResponse(`Invalid submission time format: "${submissionTimeStr}"`)
-      return
-    }
+function parseSubmit(data) {
+  const parts = data.split("|")
+  if (parts.length < 6) return { error: "Invalid submit data format." }
+  const [id, name, address, region, submissionTimeStr, status] = parts
+  const submissionTime = parseInt(submissionTimeStr, 10)
+  if (isNaN(submissionTime)) return { error: `Invalid submission time format: "${submissionTimeStr}"` }
+  // Store time as provided by C++
+  return { row: { id, name, address, region, submission_time: submissionTime, status } }
+}
 
-    const { error } = await supabase.from("ktp_applications").insert({
-      id,
-      name,
-      address,
-      region,
-      submission_time: submissionTime, // Store time as provided by C++
-      status,
-    })
+// An insert retried after a lost response conflicts with its own earlier attempt; that counts as
+// success when the stored row is the one being submitted
+async function alreadySubmitted(row) {
+  const { data, error } = await supabase.from("ktp_applications").select("*").eq("id", row.id).maybeSingle()
+  return (
+    !error &&
+    data !== null &&
+    data.name === row.name &&
+    data.address === row.address &&
+    data.region === row.region &&
+    Number(data.submission_time) === row.submission_time
+  )
+}
 
-    if (error) {
-      writeResponse(`Error submitting application: ${error.message}`)
-      return
+async function submitMany(entries) {
+  const results = new Array(entries.length)
+  const rows = []
+  entries.forEach((data, index) => {
+    const parsed = parseSubmit(data)
+    if (parsed.error) {
+      results[index] = { status: "error", message: parsed.error }
+    } else {
+      rows.push({ index, row: parsed.row })
+    }
+  })
+  if (rows.length === 0) return results
+
+  const { error } = await supabase.from("ktp_applications").insert(rows.map((entry) => entry.row))
+  if (!error) {
+    rows.forEach((entry) => (results[entry.index] = ok(`Application submitted successfully. ID: ${entry.row.id}`)))
+  } else if (!error.code) {
+    rows.forEach((entry) => (results[entry.index] = failure(error, "Error submitting application")))
+  } else {
+    // One bad row rejects the whole insert; insert row by row to find out which one
+    for (const entry of rows) {
+      const { error: rowError } =
+        rows.length === 1 ? { error } : await supabase.from("ktp_applications").insert(entry.row)
+      if (!rowError || (rowError.code === "23505" && (await alreadySubmitted(entry.row)))) {
+        results[entry.index] = ok(`Application submitted successfully. ID: ${entry.row.id}`)
+      } else {
+        results[entry.index] = failure(rowError, "Error submitting application")
+      }
     }
-
-    writeResponse(`Application submitted successfully. ID: ${id}`)
-    await writeApplicationsToFile()
-  } catch (error) {
-    writeResponse(`Error in handleSubmit: ${error.message}`)
   }
+  return results
 }
 
-// Handle verify command
-async function handleVerify(id) {
-  try {
-    const { error } = await supabase.from("ktp_applications").update({ status: "verified" }).eq("id", id)
-    if (error) throw error
-    writeResponse(`Application ${id} has been verified.`)
-    await writeApplicationsToFile()
-  } catch (error) {
-    writeResponse(`Error verifying application: ${error.message}`)
-  }
+async function verifyMany(ids) {
+  const { data, error } = await supabase
+    .from("ktp_applications")
+    .update({ status: "verified" })
+    .in("id", ids)
+    .select("id")
+  if (error) return ids.map(() => failure(error, "Error verifying application"))
+  const found = new Set((data || []).map((row) => row.id))
+  return ids.map((id) =>
+    found.has(id) ? ok(`Application ${id} has been verified.`) : { status: "error", message: `Error verifying application: ${id} not found` },
+  )
 }
 
-// Handle edit command
-async function handleEdit(data) {
-  try {
+async function editMany(entries) {
+  const results = new Array(entries.length)
+  const edits = []
+  entries.forEach((data, index) => {
     const parts = data.split("|")
     if (parts.length < 4) {
-      writeResponse("Invalid edit data format.")
-      return
+      results[index] = { status: "error", message: "Invalid edit data format." }
+    } else {
+      const [id, name, address, region] = parts
+      edits.push({ index, id, name, address, region })
     }
+  })
+  if (edits.length === 0) return results
+
+  const { data: currentApps, error: fetchError } = await supabase
+    .from("ktp_applications")
+    .select("*")
+    .in(
+      "id",
+      edits.map((edit) => edit.id),
+    )
+  if (fetchError) {
+    edits.forEach((edit) => (results[edit.index] = failure(fetchError, "Error editing application")))
+    return results
+  }
 
-    const [id, newName, newAddress, newRegion] = parts
+  const currentById = new Map((currentApps || []).map((app) => [app.id, app]))
+  const found = []
+  for (const edit of edits) {
+    if (currentById.has(edit.id)) {
+      found.push(edit)
+    } else {
+      results[edit.index] = { status: "error", message: `Error editing application: ${edit.id} not found` }
+    }
+  }
+  if (found.length === 0) return results
+
+  const revisionTime = new Date().toISOString()
+  const { error: revisionError } = await supabase.from("ktp_revisions").insert(
+    found.map((edit) => {
+      const current = currentById.get(edit.id)
+      return {
+        application_id: edit.id,
+        name: current.name,
+        address: current.address,
+        region: current.region,
+        submission_time: current.submission_time,
+        status: current.status,
+        revision_time: revisionTime,
+      }
+    }),
+  )
+  if (revisionError) {
+    found.forEach((edit) => (results[edit.index] = failure(revisionError, "Error editing application", false)))
+    return results
+  }
 
-    const { data: currentApp, error: fetchError } = await supabase
-      .from("ktp_applications")
-      .select("*")
-      .eq("id", id)
-      .single()
-
-    if (fetchError) throw fetchError
-
-    const { error: revisionError } = await supabase.from("ktp_revisions").insert({
-      application_id: id,
-      name: currentApp.name,
-      address: currentApp.address,
-      region: currentApp.region,
-      submission_time: currentApp.submission_time,
-      status: currentApp.status,
-      revision_time: new Date().toISOString(),
-    })
+  // Only the edited columns are written, so a concurrent change to any other column is kept.
+  // The updates run in parallel; the revision insert above is already a single request.
+  const updates = await Promise.all(
+    found.map((edit) =>
+      supabase
+        .from("ktp_applications")
+        .update({ name: edit.name, address: edit.address, region: edit.region, status: "revision" })
+        .eq("id", edit.id),
+    ),
+  )
+  found.forEach((edit, i) => {
+    const { error: updateError } = updates[i]
+    results[edit.index] = updateError
+      ? failure(updateError, "Error editing application", false)
+      : ok(`Application updated. ID: ${edit.id}`)
+  })
+  return results
+}
 
-    if (revisionError) throw revisionError
+async function undoRevision(id) {
+  const { data: revisions, error: fetchError } = await supabase
+    .from("ktp_revisions")
+    .select("*")
+    .eq("application_id", id)
+    .order("revision_time", { ascending: false })
+    .limit(1)
+
+  if (fetchError) return failure(fetchError, "Error undoing revision")
+  if (!revisions || revisions.length === 0) {
+    return { status: "error", message: `No revisions found for application ${id}` }
+  }
 
-    const { error: updateError } = await supabase
-      .from("ktp_applications")
-      .update({ name: newName, address: newAddress, region: newRegion, status: "revision" })
-      .eq("id", id)
+  const lastRevision = revisions[0]
+  const { error: updateError } = await supabase
+    .from("ktp_applications")
+    .update({
+      name: lastRevision.name,
+      address: lastRevision.address,
+      region: lastRevision.region,
+      status: lastRevision.status,
+    })
+    .eq("id", id)
 
-    if (updateError) throw updateError
+  if (updateError) return failure(updateError, "Error undoing revision")
 
-    writeResponse(`Application updated. ID: ${id}`)
-    await writeApplicationsToFile()
+  // Re-running the undo after this delete would undo the next revision as well
+  const { error: deleteError } = await supabase.from("ktp_revisions").delete().eq("id", lastRevision.id)
+  if (deleteError) return failure(deleteError, "Error undoing revision", false)
+  return ok(`Revision undone for application ${id}`)
+}
+
+// Legacy single-command handlers
+async function runSingle(handler, data, errorPrefix) {
+  try {
+    const result = await handler(data)
+    writeResponse(result.message)
+    if (result.status === "ok") {
+      await resyncApplications()
+    }
   } catch (error) {
-    writeResponse(`Error editing application: ${error.message}`)
+    writeResponse(`${errorPrefix}: ${error.message}`)
   }
 }
 
-// Handle undo command
-async function handleUndo(id) {
-  try {
-    const { data: revisions, error: fetchError } = await supabase
-      .from("ktp_revisions")
-      .select("*")
-      .eq("application_id", id)
-      .order("revision_time", { ascending: false })
-      .limit(1)
+const handleSubmit = (data) => runSingle(async (d) => (await submitMany([d]))[0], data, "Error in handleSubmit")
+const handleVerify = (id) => runSingle(async (d) => (await verifyMany([d]))[0], id, "Error verifying application")
+const handleEdit = (data) => runSingle(async (d) => (await editMany([d]))[0], data, "Error editing application")
+const handleUndo = (id) => runSingle(undoRevision, id, "Error undoing revision")
+
+// Batch mode: node sync_command.js <command file> <response file>
+// The command file starts with "batch" (and optionally "no-resync" and "session <token>"),
+// followed by lines "<correlation id>|<command>|<data>". Consecutive commands of the same kind on
+// distinct IDs are sent as one bulk request. Each command gets a JSON line {"id", "status",
+// "message"} in the response file as soon as its segment finishes, so a later failure cannot
+// turn it into a retry; if the script dies before writing a line, the client retries that command.
+//
+// Final results are stored in ktp_command_log under "<session>:<correlation id>". A command sent
+// again (its response was lost) gets the stored result instead of running twice:
+//
+//   create table ktp_command_log (
+//     command_key text primary key,
+//     status text not null,
+//     message text,
+//     created_at timestamptz default now()
+//   );
+//
+// After a command ends in "retry", later commands for the same application ID in the batch are
+// answered "blocked" without running, so the client can resend them in their original order.
+//
+// If the command log cannot be read or written, the response file also gets a batch status line
+// {"batch":"degraded","message":"..."}. Resent commands are then not recognised, so the client
+// stops retrying commands that are not safe to run twice (submit, edit, undo).
+const bulkHandlers = { submit: submitMany, verify: verifyMany, edit: editMany }
+
+// Both return an error message (or null) so processBatch can report a degraded batch
+async function lookupResults(keys, recorded) {
+  if (keys.length === 0) return null
+  const { data, error } = await supabase.from("ktp_command_log").select("command_key,status,message").in("command_key", keys)
+  if (error) return `Command log unavailable: ${error.message}`
+  for (const row of data || []) recorded.set(row.command_key, { status: row.status, message: row.message })
+  return null
+}
 
-    if (fetchError) throw fetchError
-    if (!revisions || revisions.length === 0) {
-      writeResponse(`No revisions found for application ${id}`)
-      return
+async function recordResults(rows) {
+  if (rows.length === 0) return null
+  const { error } = await supabase.from("ktp_command_log").upsert(rows, { onConflict: "command_key", ignoreDuplicates: true })
+  return error ? `Error recording command results: ${error.message}` : null
+}
+
+async function runSegment(command, segment) {
+  if (bulkHandlers[command]) return bulkHandlers[command](segment.map((entry) => entry.data))
+  if (command === "undo") return [await undoRevision(segment[0].data)]
+  return [{ status: "error", message: `Unknown command: ${command}` }]
+}
+
+async function processBatch(batchFilePath, batchResponsePath) {
+  const lines = fs
+    .readFileSync(batchFilePath, "utf8")
+    .split("\n")
+    .map((line) => line.trim())
+    .filter(Boolean)
+  resyncAfterCommand = !lines.includes("no-resync")
+  const session = lines.find((line) => line.startsWith("session "))?.slice("session ".length)
+  const entries = lines
+    .filter((line) => line !== "batch" && line !== "no-resync" && !line.startsWith("session "))
+    .map((line) => {
+      const [correlationId, command, ...rest] = line.split("|")
+      const data = rest.join("|")
+      return { correlationId, command, data, id: data.split("|")[0], key: session ? `${session}:${correlationId}` : null }
+    })
+
+  fs.writeFileSync(batchResponsePath, "")
+  const respond = (entry, result) =>
+    fs.appendFileSync(batchResponsePath, JSON.stringify({ id: entry.correlationId, status: result.status, message: result.message }) + "\n")
+  let degraded = false
+  const reportDegraded = (message) => {
+    if (!message) return
+    console.error(message)
+    if (degraded) return
+    degraded = true
+    fs.appendFileSync(batchResponsePath, JSON.stringify({ batch: "degraded", message }) + "\n")
+  }
+
+  const recorded = new Map()
+  reportDegraded(await lookupResults(entries.map((entry) => entry.key).filter(Boolean), recorded))
+  const unresolved = new Set() // IDs whose earlier command in this batch has to be retried
+  let applied = 0
+  let index = 0
+  while (index < entries.length) {
+    const first = entries[index]
+    if (recorded.has(first.key)) {
+      respond(first, recorded.get(first.key))
+      index++
+      continue
+    }
+    if (unresolved.has(first.id)) {
+      respond(first, { status: "blocked", message: "Waiting for an earlier command for the same application" })
+      index++
+      continue
     }
 
-    const lastRevision = revisions[0]
-    const { error: updateError } = await supabase
-      .from("ktp_applications")
-      .update({
-        name: lastRevision.name,
-        address: lastRevision.address,
-        region: lastRevision.region,
-        status: lastRevision.status,
-      })
-      .eq("id", id)
+    const { command } = first
+    const segment = [first]
+    if (bulkHandlers[command]) {
+      const ids = new Set([first.id])
+      while (index + segment.length < entries.length) {
+        const next = entries[index + segment.length]
+        if (next.command !== command || ids.has(next.id) || unresolved.has(next.id) || recorded.has(next.key)) break
+        segment.push(next)
+        ids.add(next.id)
+      }
+    }
 
-    if (updateError) throw updateError
+    let segmentResults
+    try {
+      segmentResults = await runSegment(command, segment)
+    } catch (error) {
+      // Part of the segment may already be applied, so it is not retried
+      segmentResults = segment.map(() => ({ status: "error", message: `Error processing ${command}: ${error.message}` }))
+    }
 
-    await supabase.from("ktp_revisions").delete().eq("id", lastRevision.id)
+    const finished = []
+    segment.forEach((entry, i) => {
+      const result = segmentResults[i]
+      if (result.status === "retry") {
+        unresolved.add(entry.id)
+      } else if (entry.key) {
+        finished.push({ command_key: entry.key, status: result.status, message: result.message })
+      }
+      if (result.status === "ok") applied++
+    })
+    reportDegraded(await recordResults(finished))
+    segment.forEach((entry, i) => respond(entry, segmentResults[i]))
+    index += segment.length
+  }
 
-    writeResponse(`Revision undone for application ${id}`)
-    await writeApplicationsToFile()
-  } catch (error) {
-    writeResponse(`Error undoing revision: ${error.message}`)
+  console.log(`Processed ${entries.length} commands.`)
+  if (applied > 0) {
+    await resyncApplications()
   }
 }
 
@@ -206,6 +427,7 @@ async function processCommand() {
     const fileContent = fs.readFileSync(commandFilePath, "utf8").split("\n")
     const command = fileContent[0]?.trim()
     const data = fileContent[1]?.trim()
+    resyncAfterCommand = fileContent[2]?.trim() !== "no-resync"
 
     if (!command || !data) {
       writeResponse("Invalid command file format.")
@@ -240,9 +462,17 @@ async function processCommand() {
 
 // Main function
 async function main() {
+  const [batchFilePath, batchResponsePath] = process.argv.slice(2)
+  if (batchFilePath && batchResponsePath) {
+    await processBatch(batchFilePath, batchResponsePath)
+    return
+  }
   console.log("Starting command processing...")
   await processCommand()
   console.log("Command processing complete.")
 }
 
-main().catch((error) => writeResponse(`Unhandled error in main: ${error.message}`))
+main().catch((error) => {
+  writeResponse(`Unhandled error in main: ${error.message}`)
+  process.exitCode = 1
+})